@@ -0,0 +1,73 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+/**
+ * Startphasen als Bits einer gemeinsamen Event-Gruppe.
+ *
+ * Jede Phase wird genau einmal als erledigt markiert; abhängige Tasks warten mit
+ * boot_wait() auf die Phasen, die sie brauchen, statt app_main seriell abzuarbeiten.
+ * Fahren (ESPNOW, Motoren, Joystick) hängt nicht von WLAN-Verbindung, NTP oder MQTT ab.
+ */
+typedef enum {
+    BOOT_NVS           = BIT0,  // NVS initialisiert
+    BOOT_MOTOR         = BIT1,  // Motoren, LEDs und Taste bereit
+    BOOT_WIFI_STARTED  = BIT2,  // Wi-Fi-Treiber läuft (Voraussetzung für ESPNOW), noch ohne Verbindung
+    BOOT_ESPNOW        = BIT3,  // ESPNOW initialisiert, Discovery läuft
+    BOOT_ROLE          = BIT4,  // Rolle (Controller/Auto) entschieden
+    BOOT_DRIVABLE      = BIT5,  // Controller sendet bzw. Auto setzt Befehle um
+    BOOT_NET           = BIT6,  // IP erhalten
+    BOOT_TIME          = BIT7,  // NTP-Versuch abgeschlossen (erfolgreich oder nicht)
+    BOOT_MQTT          = BIT8,  // MQTT verbunden
+    BOOT_SENSORS       = BIT9,  // Sensoren initialisiert
+    BOOT_FIRST_PUBLISH = BIT10, // erste Messwerte an MQTT übergeben
+} boot_stage_t;
+
+/**
+ * Legt die Event-Gruppe an. Als Erstes in app_main aufrufen.
+ *
+ * Zeitbasis aller Angaben ist esp_timer_get_time(), also die Zeit seit dem Systemstart.
+ */
+void boot_init(void);
+
+/**
+ * Markiert eine Phase als erledigt, merkt sich den Zeitpunkt und loggt ihn.
+ *
+ * Weitere Aufrufe für dieselbe Phase sind wirkungslos. Aus beliebigen Tasks aufrufbar,
+ * nicht aus ISRs.
+ *
+ * @param stage Genau eine Phase.
+ */
+void boot_stage_done(boot_stage_t stage);
+
+/**
+ * Blockiert, bis alle angegebenen Phasen erledigt sind.
+ *
+ * @param stages  ODER-Verknüpfung von boot_stage_t.
+ * @param timeout Maximale Wartezeit in OS-Ticks (portMAX_DELAY für unbegrenzt).
+ * @return true, wenn alle Phasen innerhalb des Timeouts erledigt wurden.
+ */
+bool boot_wait(EventBits_t stages, TickType_t timeout);
+
+/**
+ * @param stage Genau eine Phase.
+ * @return true, wenn die Phase bereits erledigt ist.
+ */
+bool boot_stage_is_done(boot_stage_t stage);
+
+/**
+ * @param stage Genau eine Phase.
+ * @return Millisekunden seit Systemstart bis zum Abschluss der Phase; -1, wenn noch offen.
+ */
+int32_t boot_stage_ms(boot_stage_t stage);
+
+/**
+ * Loggt alle Phasen mit ihren Abschlusszeiten in einer Zeile (offene als "-").
+ */
+void boot_log_summary(void);
+
+#endif // BOOT_H
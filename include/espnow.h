@@ -13,14 +13,32 @@
 #define ESPNOW_MAX_MESSAGE_SIZE 8192
 #endif
 
-// Maximale Anzahl gleichzeitiger Reassemblierungen pro Absender
+// Maximale Anzahl gleichzeitiger Reassemblierungen (alle Absender zusammen).
+// Ist die Tabelle voll, wird die am längsten ruhende Nachricht verdrängt.
 #ifndef ESPNOW_MAX_INFLIGHT_MESSAGES
 #define ESPNOW_MAX_INFLIGHT_MESSAGES 4
 #endif
 
-// Maximale Anzahl bekannter Peers, die wir verwalten
+// Nach so vielen ms ohne neues Fragment wird eine unvollständige Nachricht verworfen
+#ifndef ESPNOW_REASM_TIMEOUT_MS
+#define ESPNOW_REASM_TIMEOUT_MS 2000
+#endif
+
+// Maximale Anzahl Reassembly-Slots, die ein einzelner Absender belegen darf (0 = unbegrenzt)
+#ifndef ESPNOW_MAX_SLOTS_PER_PEER
+#define ESPNOW_MAX_SLOTS_PER_PEER 2
+#endif
+
+// Maximale Anzahl Unicast-Peers im Peer-Register (Broadcast zählt nicht mit).
+// Der Treiber erlaubt höchstens ESP_NOW_MAX_TOTAL_PEER_NUM Peers; ist das Register
+// oder der Treiber voll, wird der am längsten nicht gehörte Peer verdrängt.
 #ifndef ESPNOW_MAX_PEERS
-#define ESPNOW_MAX_PEERS 1
+#define ESPNOW_MAX_PEERS 16
+#endif
+
+// Maximale Anzahl Ziele je espnow_send_multi-Aufruf (Standard: alle Peers plus Broadcast)
+#ifndef ESPNOW_MAX_FANOUT
+#define ESPNOW_MAX_FANOUT (ESPNOW_MAX_PEERS + 1)
 #endif
 
 // Länge eines Local Master Key (LMK) für verschlüsseltes ESPNOW
@@ -32,8 +50,14 @@
  * Wird aufgerufen, sobald alle Fragmente einer Nachricht eingetroffen und korrekt
  * zusammengesetzt wurden.
  *
- * Thread-Kontext: Wird aus dem ESPNOW-Callback-Kontext aufgerufen.
- * Halte die Verarbeitung kurz oder delegiere in eine Task/Warteschlange.
+ * Thread-Kontext: Bei ESPNOW_DISPATCH_INLINE aus dem ESPNOW-Callback-Kontext
+ * (Wi-Fi-Task) – dann Verarbeitung kurz halten. Bei ESPNOW_DISPATCH_TASK aus der
+ * internen Worker-Task, dort darf der Callback auch senden, loggen oder Hardware
+ * ansteuern, ohne den Wi-Fi-Stack aufzuhalten.
+ *
+ * Speicher: data zeigt direkt in den internen Reassembly-Puffer und ist nur
+ * bis zur Rückkehr des Callbacks gültig. Wird der Inhalt später benötigt,
+ * muss er kopiert werden.
  *
  * @param mac      Quell-MAC-Adresse (6 Bytes).
  * @param data     Zeiger auf vollständige Nutzdaten.
@@ -42,6 +66,115 @@
  */
 typedef void (*espnow_recv_cb_t)(const uint8_t mac[6], const uint8_t *data, size_t len, void *user_ctx);
 
+/**
+ * Abschluss-Callback für espnow_send_async() und espnow_send_multi_async().
+ *
+ * Bei mehreren Zielen wird der Callback einmal je Peer aufgerufen.
+ *
+ * Thread-Kontext: Wird aus der internen TX-Task aufgerufen. Halte die
+ * Verarbeitung kurz, sonst verzögern sich nachfolgende Sendeaufträge.
+ *
+ * @param peer_mac Ziel-MAC des Auftrags (6 Bytes).
+ * @param result   ESP_OK wenn alle Frames an den Treiber übergeben wurden, sonst Fehlercode.
+ * @param user_ctx Der bei espnow_send_async übergebene Benutzerkontext.
+ */
+typedef void (*espnow_send_done_cb_t)(const uint8_t peer_mac[6], esp_err_t result, void *user_ctx);
+
+/**
+ * Momentaufnahme des Sendepfads (Backpressure).
+ */
+typedef struct {
+    uint32_t queued;        // Aufträge in der TX-Warteschlange
+    uint32_t queue_depth;   // Kapazität der TX-Warteschlange
+    uint32_t free_credits;  // freie Plätze im Sendefenster
+    uint32_t rejected;      // seit Init abgewiesene espnow_send_async-Aufrufe (Warteschlange voll)
+    uint32_t driver_busy;   // seit Init wiederholte Frames wegen vollem Treiberpuffer
+} espnow_tx_status_t;
+
+/**
+ * Zustand eines Peers im Peer-Register.
+ */
+typedef struct {
+    uint8_t mac[6];
+    bool encrypt;           // Frames an diesen Peer werden mit LMK verschlüsselt
+    int8_t rssi;            // RSSI des zuletzt empfangenen Frames in dBm (0 = noch nichts empfangen)
+    uint8_t link_quality;   // geglättete Zustellquote der Unicast-Frames in Prozent
+    uint32_t last_seen_ms;  // Zeitpunkt des letzten empfangenen Frames (bzw. der Registrierung)
+} espnow_peer_info_t;
+
+// Anzahl Buckets des Latenz-Histogramms; die Obergrenzen (exklusiv, in ms) stehen in
+// ESPNOW_LATENCY_BOUNDS_MS, der letzte Bucket sammelt alles darüber
+#define ESPNOW_LATENCY_BUCKETS 8
+#define ESPNOW_LATENCY_BOUNDS_MS {1, 2, 5, 10, 20, 50, 100}
+
+/**
+ * Link-Statistik eines Peers (bzw. Summe), Zähler seit Registrierung bzw. Init.
+ */
+typedef struct {
+    uint32_t tx_frames;          // Frames mit Sende-Callback
+    uint32_t tx_failed;          // davon ohne MAC-Quittung (nur Unicast)
+    uint32_t rx_frames;          // empfangene Rohframes
+    uint32_t rx_messages;        // zugestellte Nachrichten
+    uint32_t frags_dropped;      // ungültige oder mangels Slot verworfene Frames
+    uint32_t reasm_timeouts;     // unvollständig verworfene Nachrichten (Timeout oder Verdrängung)
+    uint32_t dup_frags;          // doppelt empfangene Fragmente
+    int8_t rssi_avg;             // geglätteter RSSI in dBm (0 = noch kein Empfang)
+    uint32_t send_latency_hist[ESPNOW_LATENCY_BUCKETS]; // unzuverlässige Nachrichten bis Sende-Callback, siehe espnow_get_stats()
+    uint32_t ack_latency_hist[ESPNOW_LATENCY_BUCKETS];  // espnow_send_reliable bis zur Quittung
+} espnow_link_stats_t;
+
+/**
+ * Momentaufnahme aller Link-Statistiken.
+ */
+typedef struct {
+    espnow_link_stats_t other;   // Broadcast und nicht registrierte Absender
+    uint32_t rx_ring_drops;      // Frames verworfen, weil der Empfangsring voll war (DISPATCH_TASK)
+    size_t n_peers;
+    struct {
+        uint8_t mac[6];
+        espnow_link_stats_t link;
+    } peers[ESPNOW_MAX_PEERS];
+} espnow_stats_t;
+
+/**
+ * Ausführungskontext für Reassembly und Empfangs-Callback.
+ */
+typedef enum {
+    ESPNOW_DISPATCH_INLINE = 0, // direkt im ESPNOW-Callback (Wi-Fi-Task)
+    ESPNOW_DISPATCH_TASK        // Rohframes per Ringpuffer an eine eigene Worker-Task
+} espnow_dispatch_mode_t;
+
+/**
+ * Konfiguration für espnow_init_with_config().
+ *
+ * Mit ESPNOW_CONFIG_DEFAULT() initialisieren und nur benötigte Felder überschreiben.
+ */
+typedef struct {
+    wifi_interface_t ifx;             // Wi-Fi-Interface (z. B. WIFI_IF_STA)
+    espnow_recv_cb_t recv_cb;         // Callback für vollständigen Empfang (kann NULL sein)
+    void *user_ctx;                   // wird unverändert an recv_cb durchgereicht
+    espnow_dispatch_mode_t dispatch;  // Ausführungskontext des Empfangspfads
+    uint8_t worker_priority;          // FreeRTOS-Priorität der Worker-Task (nur DISPATCH_TASK)
+    uint32_t worker_stack_size;       // Stackgröße der Worker-Task in Byte (nur DISPATCH_TASK)
+    uint32_t reasm_timeout_ms;        // unvollständige Nachrichten nach dieser Ruhezeit verwerfen
+    uint8_t max_slots_per_peer;       // Reassembly-Slots je Absender (0 = unbegrenzt)
+    uint32_t tx_queue_depth;          // Aufträge, die espnow_send_async puffern kann
+    uint8_t tx_priority;              // FreeRTOS-Priorität der TX-Task
+} espnow_config_t;
+
+#define ESPNOW_CONFIG_DEFAULT() {                    \
+    .ifx = WIFI_IF_STA,                              \
+    .recv_cb = NULL,                                 \
+    .user_ctx = NULL,                                \
+    .dispatch = ESPNOW_DISPATCH_INLINE,              \
+    .worker_priority = 10,                           \
+    .worker_stack_size = 4096,                       \
+    .reasm_timeout_ms = ESPNOW_REASM_TIMEOUT_MS,     \
+    .max_slots_per_peer = ESPNOW_MAX_SLOTS_PER_PEER, \
+    .tx_queue_depth = 8,                             \
+    .tx_priority = 9,                                \
+}
+
 /**
  * Initialisiert die ESPNOW-Schicht auf einem bestehenden Wi-Fi-Interface.
  *
@@ -58,6 +191,25 @@ typedef void (*espnow_recv_cb_t)(const uint8_t mac[6], const uint8_t *data, size
  */
 esp_err_t espnow_init(wifi_interface_t ifx, espnow_recv_cb_t recv_cb, void *user_ctx);
 
+/**
+ * Initialisiert die ESPNOW-Schicht mit erweiterter Konfiguration.
+ *
+ * Wie espnow_init(), zusätzlich wählbar ist der Ausführungskontext des
+ * Empfangspfads. Bei ESPNOW_DISPATCH_TASK kopiert der Wi-Fi-Task nur den
+ * Rohframe in einen lock-freien Ringpuffer; Reassembly und recv_cb laufen in
+ * einer Worker-Task mit konfigurierbarer Priorität. Auch Sendestatus, RSSI und
+ * last_seen_ms trägt dann die Worker-Task ein; die Wi-Fi-Callbacks nehmen keine
+ * Locks. Ist ein Ring voll, werden Frames bzw. Sendestatus verworfen (Zähler wird
+ * von der Worker-Task geloggt).
+ *
+ * @param cfg Konfiguration (darf nicht NULL sein).
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_INVALID_ARG bei cfg == NULL,
+ *         ESP_ERR_NO_MEM wenn Mutex oder Worker-Task nicht angelegt werden konnten,
+ *         sonst wie espnow_init().
+ */
+esp_err_t espnow_init_with_config(const espnow_config_t *cfg);
+
 /**
  * Deinitialisiert ESPNOW und gibt alle intern allokierten Ressourcen frei.
  *
@@ -71,6 +223,9 @@ esp_err_t espnow_deinit(void);
  * Hinweis:
  * - Falls der Peer bereits existiert, wird er intern zuerst entfernt und dann neu angelegt.
  * - Verschlüsselung erfordert einen 16-Byte LMK-Schlüssel.
+ * - Unicast-Peers werden im Peer-Register geführt. Sind bereits ESPNOW_MAX_PEERS
+ *   registriert oder meldet der Treiber ESP_ERR_ESPNOW_FULL, wird der am längsten
+ *   nicht gehörte Peer (bei encrypt=true bevorzugt ein verschlüsselter) entfernt.
  *
  * @param peer_mac MAC-Adresse des Gegenübers (6 Bytes, darf nicht NULL sein).
  * @param lmk      Optionaler LMK-Schlüssel (16 Bytes) bei encrypt=true, sonst NULL.
@@ -92,13 +247,47 @@ esp_err_t espnow_add_peer(const uint8_t peer_mac[6], const uint8_t *lmk, bool en
  */
 esp_err_t espnow_remove_peer(const uint8_t peer_mac[6]);
 
+/**
+ * Prüft, ob ein Unicast-Peer im Peer-Register steht (O(1), Hash über die MAC).
+ *
+ * @param peer_mac MAC-Adresse (6 Bytes).
+ * @return true wenn registriert, sonst false.
+ */
+bool espnow_peer_known(const uint8_t peer_mac[6]);
+
+/**
+ * Liefert den Zustand eines registrierten Peers.
+ *
+ * @param peer_mac MAC-Adresse (6 Bytes).
+ * @param out      Ziel für den Peer-Zustand.
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_NOT_FOUND wenn der Peer nicht registriert ist,
+ *         ESP_ERR_INVALID_ARG bei NULL-Parametern.
+ */
+esp_err_t espnow_get_peer(const uint8_t peer_mac[6], espnow_peer_info_t *out);
+
+/**
+ * Kopiert den Zustand aller registrierten Peers (ohne Broadcast).
+ *
+ * @param out Ziel-Array mit max Einträgen.
+ * @param max Kapazität von out.
+ * @return Anzahl geschriebener Einträge.
+ */
+size_t espnow_get_peers(espnow_peer_info_t *out, size_t max);
+
 /**
  * Sendet eine Nachricht beliebiger Länge an einen Peer.
  *
  * Implementierungshinweis:
- * - Daten werden automatisch in Fragmente aufgeteilt und am Empfänger reassembliert.
+ * - Nachrichten, die in einen einzelnen ESPNOW-Frame passen (z. B. Steuerbefehle),
+ *   werden unfragmentiert gesendet und am Empfänger ohne Reassembly zugestellt.
+ * - Größere Daten werden automatisch in Fragmente aufgeteilt und am Empfänger reassembliert.
  * - Begrenzung durch ESPNOW_MAX_FRAGMENTS und ESPNOW_FRAGMENT_PAYLOAD; effektiv
  *   darf len nicht größer sein als ESPNOW_MAX_MESSAGE_SIZE.
+ * - Jeder Frame belegt bis zu seinem Sende-Callback einen Platz im Sendefenster;
+ *   ist das Fenster voll, wartet der Aufruf kurz.
+ * - Keine Zustellgarantie: ein verlorenes Fragment verwirft die ganze Nachricht.
+ *   Für Quittierung und gezielte Wiederholung siehe espnow_send_reliable().
  *
  * @param peer_mac Ziel-MAC (6 Bytes).
  * @param data     Zeiger auf Nutzdaten (kann bei len=0 NULL sein).
@@ -110,6 +299,113 @@ esp_err_t espnow_remove_peer(const uint8_t peer_mac[6]);
  */
 esp_err_t espnow_send(const uint8_t peer_mac[6], const void *data, size_t len);
 
+/**
+ * Reiht eine Nachricht in die TX-Warteschlange ein und kehrt sofort zurück.
+ *
+ * Die interne TX-Task sendet die Frames im Takt der Sende-Callbacks
+ * (Sendefenster), sodass auch große Nachrichten den Treiberpuffer nicht
+ * überlaufen lassen.
+ *
+ * Speicher: Nachrichten, die in einen einzelnen Frame passen, werden kopiert;
+ * der Puffer darf sofort wiederverwendet werden. Bei größeren Nachrichten
+ * muss data bis zum Aufruf von done_cb gültig bleiben.
+ *
+ * @param peer_mac Ziel-MAC (6 Bytes).
+ * @param data     Zeiger auf Nutzdaten (kann bei len=0 NULL sein).
+ * @param len      Länge der Nutzdaten in Byte.
+ * @param done_cb  Optionaler Abschluss-Callback (kann NULL sein).
+ * @param user_ctx Kontext für done_cb.
+ * @return ESP_OK wenn eingereiht,
+ *         ESP_ERR_INVALID_STATE wenn nicht initialisiert oder Parameter ungültig,
+ *         ESP_ERR_NO_MEM wenn Nachricht zu groß,
+ *         ESP_ERR_TIMEOUT wenn die Warteschlange voll ist (Backpressure, Auftrag verworfen).
+ */
+esp_err_t espnow_send_async(const uint8_t peer_mac[6], const void *data, size_t len,
+                            espnow_send_done_cb_t done_cb, void *user_ctx);
+
+/**
+ * Sendet dieselbe Nachricht an mehrere Peers.
+ *
+ * Die Nachricht wird nur einmal fragmentiert und kodiert (eine Msg-ID für alle
+ * Ziele); jeder fertige Frame wird anschließend an alle Peers verteilt. Scheitert
+ * ein Frame an einem Peer, erhält dieser Peer den Rest der Nachricht nicht mehr,
+ * die übrigen Peers sind davon unberührt.
+ *
+ * @param peers      Ziel-MACs (auch Broadcast), n_peers Einträge.
+ * @param n_peers    Anzahl Ziele (1..ESPNOW_MAX_FANOUT).
+ * @param data       Zeiger auf Nutzdaten (kann bei len=0 NULL sein).
+ * @param len        Länge der Nutzdaten in Byte.
+ * @param status_out Optional: n_peers Einträge, Ergebnis je Peer.
+ * @return ESP_OK wenn alle Peers erfolgreich bedient wurden,
+ *         ESP_FAIL wenn mindestens ein Peer scheiterte (Details in status_out),
+ *         ESP_ERR_INVALID_ARG bei ungültiger Peer-Anzahl,
+ *         sonst wie espnow_send().
+ */
+esp_err_t espnow_send_multi(const uint8_t peers[][6], size_t n_peers, const void *data, size_t len,
+                            esp_err_t *status_out);
+
+/**
+ * Asynchrone Variante von espnow_send_multi().
+ *
+ * Es gelten die Speicherregeln von espnow_send_async(); done_cb wird je Peer
+ * mit dessen Ergebnis aufgerufen.
+ *
+ * @return wie espnow_send_async(), zusätzlich ESP_ERR_INVALID_ARG bei ungültiger Peer-Anzahl.
+ */
+esp_err_t espnow_send_multi_async(const uint8_t peers[][6], size_t n_peers, const void *data, size_t len,
+                                  espnow_send_done_cb_t done_cb, void *user_ctx);
+
+/**
+ * Liefert die Link-Statistik aller registrierten Peers.
+ *
+ * Die Zähler werden lockfrei fortgeschrieben; die Momentaufnahme ist je Zähler
+ * konsistent, aber nicht über alle Zähler hinweg. Zwei getrennte Latenz-Histogramme
+ * je Ziel: send_latency_hist misst vom Aufruf (bzw. Einreihen bei espnow_send_async)
+ * bis zum Sende-Callback des letzten Frames, also bis der Treiber ihn abgeschlossen
+ * hat; ack_latency_hist misst espnow_send_reliable bis zur Quittung des Empfängers.
+ *
+ * @param out Ziel der Momentaufnahme.
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_INVALID_ARG bei out=NULL,
+ *         ESP_ERR_INVALID_STATE wenn nicht initialisiert.
+ */
+esp_err_t espnow_get_stats(espnow_stats_t *out);
+
+/**
+ * Liefert den aktuellen Zustand des Sendepfads.
+ *
+ * @param out Ausgabestruktur.
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_INVALID_ARG wenn out NULL ist,
+ *         ESP_ERR_INVALID_STATE wenn nicht initialisiert.
+ */
+esp_err_t espnow_get_tx_status(espnow_tx_status_t *out);
+
+/**
+ * Sendet eine Nachricht zuverlässig (Selective Repeat) an einen Unicast-Peer.
+ *
+ * Ablauf:
+ * - Fragmente werden im Sendefenster (ESPNOW_TX_WINDOW) verschickt; das letzte
+ *   Fragment jeder Runde fordert vom Empfänger eine NACK-Bitmap an.
+ * - Der Empfänger meldet die bereits erhaltenen Fragmente; wiederholt werden nur
+ *   die fehlenden. Bleibt die Antwort aus, fragt der Sender per POLL nach.
+ * - Der Empfänger quittiert eine vollständige Nachricht, bevor er sie zustellt.
+ *
+ * Blockiert, bis die Nachricht bestätigt ist oder ESPNOW_RELIABLE_MAX_ROUNDS
+ * Runden erfolglos waren. Es läuft höchstens eine zuverlässige Übertragung
+ * gleichzeitig; weitere Aufrufer warten. Nicht aus dem Empfangs-Callback aufrufen.
+ *
+ * @param peer_mac Ziel-MAC (6 Bytes, kein Broadcast).
+ * @param data     Zeiger auf Nutzdaten (kann bei len=0 NULL sein).
+ * @param len      Länge der Nutzdaten in Byte (max. ESPNOW_MAX_MESSAGE_SIZE).
+ * @return ESP_OK wenn der Empfänger die vollständige Nachricht bestätigt hat,
+ *         ESP_ERR_INVALID_STATE wenn nicht initialisiert oder Parameter ungültig,
+ *         ESP_ERR_INVALID_ARG bei Broadcast-Ziel,
+ *         ESP_ERR_NO_MEM wenn Nachricht zu groß,
+ *         ESP_ERR_TIMEOUT wenn keine Bestätigung eintraf.
+ */
+esp_err_t espnow_send_reliable(const uint8_t peer_mac[6], const void *data, size_t len);
+
 /**
  * Liefert die MAC-Adresse des gebundenen Interfaces (z. B. STA-MAC).
  *
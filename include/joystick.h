@@ -2,45 +2,58 @@
 #define HTWK_C960_IOT_JOYSTICK_H
 
 #include <esp_log.h>
-#include "driver/adc.h"
+#include "esp_adc/adc_continuous.h"
 #include "driver/gpio.h"
+#include "nvs.h"
 #include "motor.h"
+#include "joystick_norm.h"
+#include "joystick_filter.h"
 
 // --- Joystick/Role Config ---
-#define JS_ADC_WIDTH          ADC_WIDTH_BIT_12   // 0..4095
-#define JS_ADC_ATTEN          ADC_ATTEN_DB_11    // voller Bereich bis ~3.3V
-// Passe die Kanäle an deine Pins an (z. B. VRx -> GPIO34 = ADC1_CH6, VRy -> GPIO35 = ADC1_CH7)
-#define JS_AXIS_X_CH          ADC1_CHANNEL_2     // GPIO2
-#define JS_AXIS_Y_CH          ADC1_CHANNEL_3     // GPIO3
+#define JS_ADC_WIDTH          ADC_BITWIDTH_12    // 0..4095
+#define JS_ADC_ATTEN          ADC_ATTEN_DB_12    // voller Bereich bis ~3.3V
+// Passe die Kanäle an deine Pins an (ESP32-C6: GPIOn = ADC1_CHn für n = 0..6)
+#define JS_AXIS_X_CH          ADC_CHANNEL_2      // GPIO2
+#define JS_AXIS_Y_CH          ADC_CHANNEL_3      // GPIO3
 #define JS_BTN_GPIO           GPIO_NUM_11        // Joystick SW; GND beim Drücken
 #define JS_BTN_ACTIVE_LEVEL   0
 
-#define JS_SAMPLE_INTERVAL_MS 50
-#define JS_DEADZONE_PC        10     // Prozent rund um die Mitte
+// Kontinuierliche Abtastung per DMA: der ADC wandelt beide Achsen abwechselnd mit
+// JS_ADC_SAMPLE_HZ (Summe über beide Kanäle). Je JS_SAMPLE_INTERVAL_MS entsteht ein
+// DMA-Frame, dessen Werte je Achse gemittelt werden (Oversampling/Dezimierung).
+#define JS_SAMPLE_INTERVAL_MS 20     // Abtastrate 50 Hz; Senden nur bei Änderung bzw. Keepalive
+#define JS_ADC_SAMPLE_HZ      2000   // >= SOC_ADC_SAMPLE_FREQ_THRES_LOW
+#define JS_ADC_FRAME_CONV     (JS_ADC_SAMPLE_HZ * JS_SAMPLE_INTERVAL_MS / 1000)
+#define JS_ADC_FRAME_BYTES    (JS_ADC_FRAME_CONV * SOC_ADC_DIGI_RESULT_BYTES)
+#define JS_ADC_POOL_FRAMES    4      // Frames im Treiberpuffer, bevor Messwerte verworfen werden
 #define JS_ACTIVITY_THRESHOLD 8      // Änderung in %-Punkten, die als "Bewegung" gilt
 #define ROLE_DECISION_MS      5000   // Wie lange nach Boot auf Aktivität warten
 #define JS_CALIB_MS           800    // Zeitfenster zur Mittelwert-Kalibrierung
 #define JS_CALIB_SWEEP_MS     5000   // Zusätzliche Zeit zum Erfassen von min/max der Achsen
-#define JS_ADAPT_EPS          2      // Rohwert-Differenz, ab der min/max adaptiv erweitert werden
+#define JS_CALIB_SAVE_DELAY_MS 10000 // Erweiterte Extrema erst speichern, wenn sie so lange stabil waren
+#define JS_CALIB_NVS_NAMESPACE "joystick"
+#define JS_CALIB_NVS_KEY      "calib"
+#define JS_CALIB_VERSION      1      // bei Änderung des Datensatzes erhöhen; alte Datensätze werden verworfen
 #define LED_CALIB_SWEEP		  0		 // Pin für die LED, die zum Callibrieren leuchtet
 // --- Befehlsprotokoll ---
-#define CMD_PROTO_VER 1
+#define CMD_PROTO_VER 2             // v2: Sequenznummer, Zeitstempel, Echo
 #define CMD_MAGIC0    'C'
 #define CMD_MAGIC1    'M'
+// Sendestrategie: sofort bei Änderung, sonst Keepalive; das Auto stoppt ohne Befehl nach Timeout
+#define JS_SEND_DELTA_PC      JS_ACTIVITY_THRESHOLD // Änderung in %-Punkten, die sofort gesendet wird
+#define JS_KEEPALIVE_MS       500    // Wiederholung des letzten Zustands ohne Änderung
+#define JS_CMD_TIMEOUT_MS     (3 * JS_KEEPALIVE_MS)  // Auto: Motoren stoppen, wenn so lange nichts kam
+#define CMD_ECHO_EVERY        1      // Controller: jeder n-te Befehl fordert ein Echo an (0 = nie)
+#define CMD_SEQ_SENDERS       4      // Auto: Anzahl Controller, deren Sequenznummern verfolgt werden
 
 typedef enum : uint8_t
 {
-	CMD_JOYSTICK = 1
+	CMD_JOYSTICK = 1,
+	CMD_ECHO     = 2   // Auto -> Controller: Antwort auf CMD_FLAG_ECHO_REQ
 } cmd_type_t;
 
-// Neue Kalibrierstruktur je Achse
-typedef struct
-{
-	int min;
-	int mid;
-	int max;
-	bool inited;
-} axis_calib_t;
+// cmd_joystick_t.flags
+#define CMD_FLAG_ECHO_REQ 0x01   // Empfänger soll seq/t_ms per CMD_ECHO zurückschicken
 
 typedef struct __attribute__((packed))
 {
@@ -52,11 +65,30 @@ typedef struct __attribute__((packed))
 typedef struct __attribute__((packed))
 {
 	cmd_hdr_t hdr;
+	uint16_t seq; // fortlaufend je Controller; Broadcast- und Unicast-Kopie tragen dieselbe
+	uint32_t t_ms; // Sendezeitpunkt in ms seit Boot des Controllers
 	int8_t x_pct; // -100..+100 (links/rechts)
 	int8_t y_pct; // -100..+100 (vor/zurück)
 	uint8_t buttons; // Bit0: SW (gedrückt)
+	uint8_t flags; // CMD_FLAG_*
 } cmd_joystick_t;
 
+typedef struct __attribute__((packed))
+{
+	cmd_hdr_t hdr;
+	uint16_t seq; // aus dem beantworteten Befehl
+	uint32_t t_ms; // unverändert zurück, der Controller bildet daraus die Round-Trip-Zeit
+} cmd_echo_t;
+
+// Ein dezimierter Messwert beider Achsen (Mittel über einen DMA-Frame)
+typedef struct
+{
+	int x;            // Rohwert 0..4095
+	int y;            // Rohwert 0..4095
+	uint16_t n_x;     // Anzahl gemittelter Wandlungen X
+	uint16_t n_y;     // Anzahl gemittelter Wandlungen Y
+} js_sample_t;
+
 typedef enum
 {
 	ROLE_UNKNOWN = 0,
@@ -69,54 +101,54 @@ static role_t s_role = ROLE_UNKNOWN;
 /**
  * Initialisiert die Joystick-Hardware.
  *
- * Richtet die ADC-Breite und Dämpfung für X-/Y-Achsen ein und konfiguriert
- * den Button-GPIO als Eingang mit Pull-up. Muss einmalig vor der Nutzung
- * anderer Joystick-Funktionen aufgerufen werden.
+ * Startet den ADC im Continuous-Modus (DMA) für X-/Y-Achse mit JS_ADC_SAMPLE_HZ
+ * und konfiguriert den Button-GPIO als Eingang mit Pull-up. Muss einmalig vor
+ * der Nutzung anderer Joystick-Funktionen aufgerufen werden.
  */
 void joystick_init(void);
 
 /**
- * Liest den Rohwert einer angegebenen ADC1-Achse.
+ * Wartet auf den nächsten DMA-Frame und liefert den Mittelwert je Achse.
  *
- * @param ch ADC1-Kanal der zu lesenden Achse (z. B. JS_AXIS_X_CH).
- * @return Rohwert im Bereich 0..4095 entsprechend JS_ADC_WIDTH.
- */
-int read_raw_axis(adc1_channel_t ch);
-
-/**
- * Normalisiert einen Rohwert unter Verwendung einer Achsen-Kalibrierung
- * auf einen Prozentwert von -100..+100.
+ * Die Frames entstehen hardwaregetaktet alle JS_SAMPLE_INTERVAL_MS; der Aufruf
+ * taktet damit die Abtastung. Liegen mehrere Frames vor (Aufrufer war zu langsam),
+ * wird nur der neueste ausgewertet, damit keine veralteten Werte gesendet werden.
  *
- * Berücksichtigt den kalibrierten Mittelpunkt sowie asymmetrische Spannen
- * zu min/max und wendet eine Deadzone um 0% an.
- *
- * @param raw Aktueller ADC-Rohwert.
- * @param c   Zeiger auf die Kalibrierungsdaten der Achse (c->inited muss true sein).
- * @return Prozentwert [-100..100]; 0 falls Kalibrierung ungültig.
+ * @param out        Ziel für den dezimierten Messwert.
+ * @param timeout_ms Maximale Wartezeit in ms (ADC_MAX_DELAY = unbegrenzt).
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_TIMEOUT wenn kein Frame eintraf,
+ *         ESP_ERR_INVALID_ARG bei out=NULL,
+ *         ESP_ERR_INVALID_STATE wenn joystick_init() fehlt.
  */
-int8_t normalize_axis_with_cal(int raw, const axis_calib_t *c);
+esp_err_t joystick_read_sample(js_sample_t *out, uint32_t timeout_ms);
 
 /**
- * Passt die gespeicherten min/max-Werte einer Kalibrierung adaptiv an,
- * falls neue Extrema mit einem Sicherheitsabstand (JS_ADAPT_EPS) erreicht werden.
+ * Lädt die Kalibrierung beider Achsen aus dem NVS.
+ *
+ * Der Datensatz ist versioniert (JS_CALIB_VERSION) und wird auf Plausibilität
+ * geprüft; bei Erfolg sind beide Kalibrierungen initialisiert.
  *
- * @param c   Zeiger auf die Kalibrierungsdaten (muss initialisiert sein).
- * @param raw Neuer beobachteter Rohwert.
+ * @param x Ziel für die Kalibrierung der X-Achse.
+ * @param y Ziel für die Kalibrierung der Y-Achse.
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_NVS_NOT_FOUND wenn noch nichts gespeichert ist,
+ *         ESP_ERR_INVALID_VERSION bei anderer Datensatzversion,
+ *         ESP_ERR_INVALID_STATE bei unplausiblen Werten,
+ *         sonst Fehler von nvs_open()/nvs_get_blob().
  */
-void adapt_axis_calib(axis_calib_t *c, int raw);
+esp_err_t joystick_calib_load(axis_calib_t *x, axis_calib_t *y);
 
 /**
- * Normalisiert einen Rohwert relativ zu einem gegebenen Mittelpunkt auf -100..+100.
- *
- * Der Mittelpunkt wird als kalibrierter Midpoint interpretiert; die positive und
- * negative Spanne werden asymmetrisch bis zu den theoretischen Enden 0 bzw. 4095
- * berechnet. Eine Deadzone um 0% wird angewandt.
+ * Speichert die Kalibrierung beider Achsen im NVS.
  *
- * @param raw Aktueller ADC-Rohwert.
- * @param mid Kalibrierter Mittelpunkt (0..4095).
- * @return Prozentwert [-100..100].
+ * @param x Kalibrierung der X-Achse (muss initialisiert sein).
+ * @param y Kalibrierung der Y-Achse (muss initialisiert sein).
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_INVALID_ARG bei fehlender oder uninitialisierter Kalibrierung,
+ *         sonst Fehler von nvs_open()/nvs_set_blob()/nvs_commit().
  */
-int8_t normalize_axis_to_pct_cal(int raw, int mid);
+esp_err_t joystick_calib_save(const axis_calib_t *x, const axis_calib_t *y);
 
 /**
  * Liest den Zustand des Joystick-Buttons.
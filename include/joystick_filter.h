@@ -0,0 +1,134 @@
+#ifndef HTWK_C960_IOT_JOYSTICK_FILTER_H
+#define HTWK_C960_IOT_JOYSTICK_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Filterstufe zwischen ADC-Rohwert und Normalisierung: Median gegen Ausreißer,
+// danach Glättung (IIR oder 1€-Filter) und Anstiegsbegrenzung, nach der Normalisierung
+// eine Deadzone mit Hysterese. Ganzzahlig (keine FPU auf dem ESP32-C6), unabhängig von ESP-IDF.
+
+// Glättungsverfahren
+typedef enum
+{
+	JS_SMOOTH_NONE = 0,
+	JS_SMOOTH_IIR,          // einpoliger Tiefpass mit festem Gewicht
+	JS_SMOOTH_ONE_EURO      // 1€-Filter: Grenzfrequenz steigt mit der Geschwindigkeit
+} js_smooth_t;
+
+// --- Build-Zeit-Voreinstellungen (zur Laufzeit über js_filter_configure() änderbar) ---
+#ifndef JS_FILTER_MEDIAN_N
+#define JS_FILTER_MEDIAN_N            3      // 1 = aus, sonst ungerade bis JS_FILTER_MEDIAN_MAX
+#endif
+#ifndef JS_FILTER_SMOOTH
+#define JS_FILTER_SMOOTH              JS_SMOOTH_ONE_EURO
+#endif
+#ifndef JS_FILTER_IIR_ALPHA_PCT
+#define JS_FILTER_IIR_ALPHA_PCT       30     // Gewicht des neuen Werts in %
+#endif
+#ifndef JS_FILTER_EURO_MIN_CUTOFF_MHZ
+#define JS_FILTER_EURO_MIN_CUTOFF_MHZ 1000   // Grenzfrequenz in Ruhe (1 Hz)
+#endif
+#ifndef JS_FILTER_EURO_BETA_UHZ
+#define JS_FILTER_EURO_BETA_UHZ       100    // Zuwachs der Grenzfrequenz in µHz je Rohwert/s
+#endif
+#ifndef JS_FILTER_EURO_D_CUTOFF_MHZ
+#define JS_FILTER_EURO_D_CUTOFF_MHZ   1000   // Grenzfrequenz der Geschwindigkeitsschätzung
+#endif
+#ifndef JS_FILTER_SLEW_MAX
+#define JS_FILTER_SLEW_MAX            1024   // höchste Änderung je Periode in Rohwerten, 0 = aus
+#endif
+#ifndef JS_DEADZONE_HYST_PC
+#define JS_DEADZONE_HYST_PC           3      // Austritt aus der Deadzone erst ab JS_DEADZONE_PC + Hysterese
+#endif
+#ifndef JS_FILTER_PERIOD_MS
+#define JS_FILTER_PERIOD_MS           50     // Abtastperiode, bestimmt die 1€-Koeffizienten
+#endif
+
+#define JS_FILTER_MEDIAN_MAX 5
+
+typedef struct
+{
+	uint8_t median_n;              // Fensterlänge des Medians (1, 3 oder 5)
+	js_smooth_t smooth;
+	uint8_t iir_alpha_pct;         // JS_SMOOTH_IIR: Gewicht des neuen Werts (1..100)
+	uint32_t euro_min_cutoff_mhz;  // JS_SMOOTH_ONE_EURO: Grenzfrequenz in Ruhe in mHz
+	uint32_t euro_beta_uhz;        // JS_SMOOTH_ONE_EURO: Geschwindigkeitsanteil in µHz je Rohwert/s
+	uint32_t euro_d_cutoff_mhz;    // JS_SMOOTH_ONE_EURO: Tiefpass der Ableitung in mHz
+	uint16_t slew_max;             // Anstiegsbegrenzung in Rohwerten je Periode, 0 = aus
+	uint8_t deadzone_hyst_pc;      // 0 = statische Deadzone
+	uint16_t period_ms;            // Abtastperiode
+} js_filter_config_t;
+
+#define JS_FILTER_CONFIG_DEFAULT() { \
+	.median_n = JS_FILTER_MEDIAN_N, \
+	.smooth = JS_FILTER_SMOOTH, \
+	.iir_alpha_pct = JS_FILTER_IIR_ALPHA_PCT, \
+	.euro_min_cutoff_mhz = JS_FILTER_EURO_MIN_CUTOFF_MHZ, \
+	.euro_beta_uhz = JS_FILTER_EURO_BETA_UHZ, \
+	.euro_d_cutoff_mhz = JS_FILTER_EURO_D_CUTOFF_MHZ, \
+	.slew_max = JS_FILTER_SLEW_MAX, \
+	.deadzone_hyst_pc = JS_DEADZONE_HYST_PC, \
+	.period_ms = JS_FILTER_PERIOD_MS, \
+}
+
+// Filterzustand je Achse
+typedef struct
+{
+	js_filter_config_t cfg;
+	uint32_t iir_alpha_q16;        // vorberechnet aus cfg
+	uint32_t d_alpha_q16;          // vorberechnet aus cfg.euro_d_cutoff_mhz
+	uint16_t hist[JS_FILTER_MEDIAN_MAX];
+	uint8_t hist_len;
+	uint8_t hist_pos;
+	bool primed;
+	int32_t y_q8;                  // geglätteter Rohwert, 8 Nachkommabits
+	int32_t dx;                    // geglättete Geschwindigkeit in Rohwert/s
+	bool in_deadzone;
+} js_axis_filter_t;
+
+/**
+ * Setzt den Filter einer Achse zurück und übernimmt die Konfiguration.
+ *
+ * @param f   Filterzustand der Achse.
+ * @param cfg Konfiguration; NULL = JS_FILTER_CONFIG_DEFAULT().
+ */
+void js_filter_init(js_axis_filter_t *f, const js_filter_config_t *cfg);
+
+/**
+ * Übernimmt eine neue Konfiguration zur Laufzeit.
+ *
+ * Der geglättete Wert bleibt erhalten, sodass kein Sprung entsteht; nur bei
+ * geänderter Medianlänge wird das Medianfenster geleert. Ungültige Werte werden
+ * auf den zulässigen Bereich begrenzt.
+ *
+ * @param f   Filterzustand der Achse.
+ * @param cfg Neue Konfiguration.
+ */
+void js_filter_configure(js_axis_filter_t *f, const js_filter_config_t *cfg);
+
+/**
+ * Filtert einen ADC-Rohwert (Median, danach Glättung und Anstiegsbegrenzung).
+ *
+ * Einmal je Abtastperiode aufrufen; der erste Wert wird unverändert übernommen.
+ *
+ * @param f   Filterzustand der Achse.
+ * @param raw ADC-Rohwert (0..4095).
+ * @return Gefilterter Rohwert (0..4095).
+ */
+int js_filter_raw(js_axis_filter_t *f, int raw);
+
+/**
+ * Wendet die Deadzone-Hysterese auf einen normalisierten Prozentwert an.
+ *
+ * Ein Wert, den die Normalisierung auf 0 gesetzt hat, öffnet die Deadzone; sie
+ * wird erst ab |pct| >= JS_DEADZONE_PC + deadzone_hyst_pc wieder verlassen. So
+ * flackert die Ausgabe an der Deadzone-Kante nicht zwischen 0 und ±JS_DEADZONE_PC.
+ *
+ * @param f   Filterzustand der Achse.
+ * @param pct Ergebnis der Normalisierung [-100..100].
+ * @return Prozentwert nach Hysterese.
+ */
+int8_t js_filter_deadzone(js_axis_filter_t *f, int8_t pct);
+
+#endif //HTWK_C960_IOT_JOYSTICK_FILTER_H
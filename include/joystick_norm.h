@@ -0,0 +1,76 @@
+#ifndef HTWK_C960_IOT_JOYSTICK_NORM_H
+#define HTWK_C960_IOT_JOYSTICK_NORM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Normalisierung der Joystick-Rohwerte auf -100..+100 %, ohne Gleitkomma
+// (der ESP32-C6 hat keine FPU). Unabhängig von ESP-IDF, damit auch im Host-Build nutzbar.
+
+#define JS_DEADZONE_PC        10     // Prozent rund um die Mitte
+#define JS_ADAPT_EPS          2      // Rohwert-Differenz, ab der min/max adaptiv erweitert werden
+#define JS_RAW_MAX            4095   // 12-Bit-ADC
+#define JS_SCALE_SHIFT        24     // Festkomma-Stellen der Skalierungsfaktoren
+
+// Kalibrierstruktur je Achse
+typedef struct
+{
+	int min;
+	int mid;
+	int max;
+	bool inited;
+	uint32_t pos_scale;   // 100 / (max - mid) in Q24, von axis_calib_update() gesetzt
+	uint32_t neg_scale;   // 100 / (mid - min) in Q24
+} axis_calib_t;
+
+/**
+ * Berechnet die Skalierungsfaktoren einer Achse aus min/mid/max neu und
+ * markiert die Kalibrierung als gültig.
+ *
+ * Muss nach jeder Änderung an min/mid/max aufgerufen werden; adapt_axis_calib()
+ * erledigt das selbst.
+ *
+ * @param c Zeiger auf die Kalibrierungsdaten der Achse.
+ */
+void axis_calib_update(axis_calib_t *c);
+
+/**
+ * Normalisiert einen Rohwert unter Verwendung einer Achsen-Kalibrierung
+ * auf einen Prozentwert von -100..+100.
+ *
+ * Berücksichtigt den kalibrierten Mittelpunkt sowie asymmetrische Spannen
+ * zu min/max und wendet eine Deadzone um 0% an. Je Aufruf nur Multiplikation,
+ * Shift und Begrenzung; das Ergebnis entspricht der exakten Rechnung
+ * (raw - mid) * 100 / Spanne, zur Null hin abgeschnitten.
+ *
+ * @param raw Aktueller ADC-Rohwert.
+ * @param c   Zeiger auf die Kalibrierungsdaten der Achse (c->inited muss true sein).
+ * @return Prozentwert [-100..100]; 0 falls Kalibrierung ungültig.
+ */
+int8_t normalize_axis_with_cal(int raw, const axis_calib_t *c);
+
+/**
+ * Passt die gespeicherten min/max-Werte einer Kalibrierung adaptiv an,
+ * falls neue Extrema mit einem Sicherheitsabstand (JS_ADAPT_EPS) erreicht werden.
+ * Die Skalierungsfaktoren werden dabei nachgeführt.
+ *
+ * @param c   Zeiger auf die Kalibrierungsdaten (muss initialisiert sein).
+ * @param raw Neuer beobachteter Rohwert.
+ * @return true, wenn min oder max erweitert wurde (z. B. um sie zu speichern).
+ */
+bool adapt_axis_calib(axis_calib_t *c, int raw);
+
+/**
+ * Normalisiert einen Rohwert relativ zu einem gegebenen Mittelpunkt auf -100..+100.
+ *
+ * Der Mittelpunkt wird als kalibrierter Midpoint interpretiert; die positive und
+ * negative Spanne werden asymmetrisch bis zu den theoretischen Enden 0 bzw. 4095
+ * berechnet. Eine Deadzone um 0% wird angewandt.
+ *
+ * @param raw Aktueller ADC-Rohwert.
+ * @param mid Kalibrierter Mittelpunkt (0..4095).
+ * @return Prozentwert [-100..100].
+ */
+int8_t normalize_axis_to_pct_cal(int raw, int mid);
+
+#endif //HTWK_C960_IOT_JOYSTICK_NORM_H
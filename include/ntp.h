@@ -39,4 +39,11 @@ void time_sync_notification_cb(struct timeval *tv);
  */
 void ntp_obtain_time();
 
+/**
+ * Prüft, ob die Systemzeit plausibel ist (nach 2016), also mindestens einmal per NTP gesetzt wurde.
+ *
+ * @return true, wenn time() eine gültige Wanduhrzeit liefert.
+ */
+bool ntp_time_valid(void);
+
 #endif //HTWK_C960_IOT_NTP_H
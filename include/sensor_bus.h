@@ -0,0 +1,115 @@
+#ifndef SENSOR_BUS_H
+#define SENSOR_BUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+
+// Sensorbus auf dem i2c_master-Treiber (IDF 5). Geräte und Transaktionsdeskriptoren liegen in
+// statischen Pools, im Betrieb wird nichts vom Heap geholt. Transaktionen laufen entweder
+// synchron im Aufrufer (sensor_bus_transfer) oder asynchron im Bus-Task (sensor_bus_submit).
+#ifndef SENSOR_BUS_MAX_DEVICES
+#define SENSOR_BUS_MAX_DEVICES  4
+#endif
+#ifndef SENSOR_BUS_TXNS_PER_DEV
+#define SENSOR_BUS_TXNS_PER_DEV 4    // gleichzeitig ausstehende Transaktionen je Gerät (max. 32)
+#endif
+#ifndef SENSOR_BUS_QUEUE_DEPTH
+#define SENSOR_BUS_QUEUE_DEPTH  8    // ausstehende Einzeltransaktionen bzw. Batches im Bus-Task
+#endif
+#define SENSOR_BUS_TIMEOUT_MS   50   // je Transfer; der Bus gehört dabei exklusiv diesem Transfer
+#define SENSOR_BUS_TX_MAX       32   // max. Schreiblänge inkl. Registerbyte
+#define SENSOR_BUS_NO_REG       0xFF // reg_addr ohne vorangestelltes Registerbyte
+
+typedef struct sensor_bus_dev sensor_bus_dev_t;
+typedef struct sensor_bus_txn sensor_bus_txn_t;
+
+/**
+ * Abschluss-Callback einer asynchronen Transaktion; läuft im Bus-Task.
+ *
+ * Der Deskriptor geht nach der Rückkehr an den Pool des Geräts zurück; Ergebnisse daher
+ * hier aus txn->rx übernehmen bzw. weiterreichen, nicht den Zeiger aufheben.
+ *
+ * @param txn      Abgeschlossene Transaktion.
+ * @param result   ESP_OK oder Fehler des i2c_master-Treibers.
+ * @param user_ctx Zeiger aus txn->user_ctx.
+ */
+typedef void (*sensor_bus_done_cb_t)(sensor_bus_txn_t *txn, esp_err_t result, void *user_ctx);
+
+/**
+ * Transaktionsdeskriptor, aus dem Pool des Geräts per sensor_bus_txn_get().
+ *
+ * tx und rx zeigen auf Speicher des Aufrufers, der bis zum Abschluss gültig bleiben muss.
+ * Nur tx: Schreiben; nur rx: Lesen; beides: Schreiben, Repeated Start, Lesen.
+ */
+struct sensor_bus_txn {
+    sensor_bus_dev_t *dev;
+    uint16_t delay_ms;          // vor der Ausführung im Bus-Task warten (z. B. Messzeit des Sensors)
+    const uint8_t *tx;
+    size_t tx_len;
+    uint8_t *rx;
+    size_t rx_len;
+    sensor_bus_done_cb_t done;  // optional
+    void *user_ctx;
+    sensor_bus_txn_t *next;     // nächste Transaktion desselben Batches oder NULL
+};
+
+/**
+ * Legt den I2C-Master-Bus an (Pins/Takt aus CONFIG_I2C_MASTER_*) und startet den Bus-Task.
+ *
+ * @return ESP_OK bei Erfolg (auch bei erneutem Aufruf), sonst Fehler von i2c_new_master_bus()
+ *         bzw. ESP_ERR_NO_MEM, wenn Queue oder Task nicht angelegt werden konnten.
+ */
+esp_err_t sensor_bus_init(void);
+
+/**
+ * @return Handle des Busses für Treiber, die selbst auf i2c_master aufsetzen (z. B. BMX280);
+ *         NULL vor sensor_bus_init().
+ */
+i2c_master_bus_handle_t sensor_bus_handle(void);
+
+/**
+ * Liefert das Gerät mit der 7-Bit-Adresse addr; legt es beim ersten Aufruf an.
+ *
+ * @param addr 7-Bit-Slave-Adresse.
+ * @return Gerät oder NULL, wenn der Bus fehlt, der Pool voll ist oder der Treiber ablehnt.
+ */
+sensor_bus_dev_t *sensor_bus_device(uint8_t addr);
+
+/**
+ * Synchroner Transfer im Aufrufer-Task (Semantik wie sensor_bus_txn_t).
+ *
+ * @return ESP_OK bei Erfolg, ESP_ERR_INVALID_ARG ohne Gerät oder Daten,
+ *         sonst Fehler des i2c_master-Treibers (z. B. ESP_ERR_TIMEOUT).
+ */
+esp_err_t sensor_bus_transfer(sensor_bus_dev_t *dev, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+
+/**
+ * Holt einen freien Deskriptor aus dem Pool des Geräts; alle Felder außer dev sind genullt.
+ *
+ * @return Deskriptor oder NULL, wenn alle SENSOR_BUS_TXNS_PER_DEV ausstehen.
+ */
+sensor_bus_txn_t *sensor_bus_txn_get(sensor_bus_dev_t *dev);
+
+/**
+ * Gibt einen Deskriptor zurück, der nicht eingereicht wurde (z. B. weil ein zweiter fehlte).
+ *
+ * @param txn Deskriptor aus sensor_bus_txn_get().
+ */
+void sensor_bus_txn_put(sensor_bus_txn_t *txn);
+
+/**
+ * Reiht eine Transaktion oder einen über next verketteten Batch im Bus-Task ein; kehrt sofort zurück.
+ *
+ * Ein Batch wird ohne dazwischenliegende andere Aufträge des Bus-Tasks der Reihe nach ausgeführt; jede
+ * Transaktion meldet ihr eigenes Ergebnis, ein Fehler bricht den Rest nicht ab.
+ *
+ * @param head Erste Transaktion (aus sensor_bus_txn_get()).
+ * @return ESP_OK, wenn eingereiht; ESP_ERR_INVALID_STATE vor sensor_bus_init();
+ *         ESP_ERR_TIMEOUT, wenn die Queue voll ist (die Deskriptoren werden dann freigegeben).
+ */
+esp_err_t sensor_bus_submit(sensor_bus_txn_t *head);
+
+#endif // SENSOR_BUS_H
@@ -0,0 +1,182 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Sensorregister: Treiber melden sich mit Abtastperiode und Kanalbeschreibungen an. Ein
+// generischer Sampler-Task fragt jeden im eigenen Takt ab und legt die Messwerte als
+// einheitliche Datensätze im Ring ab; der Publisher kennt nur das Register, keine Sensoren.
+#ifndef SENSOR_MAX_DRIVERS
+#define SENSOR_MAX_DRIVERS       4
+#endif
+#define SENSOR_MAX_CHANNELS      4    // Messwerte je Datensatz (valid ist 8 Bit breit)
+#define SENSOR_NAME_MAX_LEN      15   // Zeichen in Treiber- und Kanalnamen (Telemetrie- und Topic-Puffer)
+#define SENSOR_MAX_DECIMALS      3    // Nachkommastellen eines Kanals
+#define SENSOR_PUBLISH_PERIOD_MS 10000
+#ifndef SENSOR_RING_DEPTH
+#define SENSOR_RING_DEPTH        32   // Zweierpotenz, deutlich mehr als Datensätze je Fenster
+#endif
+
+/**
+ * Fähigkeiten eines Treibers (Bitmaske in sensor_driver_t::caps).
+ */
+typedef enum : uint8_t {
+    // Messung in zwei Schritten: start() stößt die Konvertierung an, read() holt sie ab.
+    // Der Sampler startet alle fälligen Treiber, bevor er den ersten ausliest.
+    SENSOR_CAP_ASYNC  = 1u << 0,
+    // Liefert nach init() eine Zeit lang Platzhalterwerte (valid = 0), muss aber trotzdem
+    // im eigenen Takt abgefragt werden (z. B. SGP30-Baseline). Der Sampler liest weiter,
+    // legt solche Datensätze aber nicht in den Ring.
+    SENSOR_CAP_WARMUP = 1u << 1,
+} sensor_cap_t;
+
+/**
+ * Beschreibung eines Messkanals.
+ */
+typedef struct {
+    const char *name;  // Kennung, zugleich MQTT-Unterthema (/sensor/<name>); höchstens SENSOR_NAME_MAX_LEN
+    const char *unit;  // Einheit der Werte, z. B. "hPa"
+    uint8_t decimals;  // Nachkommastellen bei der Ausgabe, höchstens SENSOR_MAX_DECIMALS
+} sensor_channel_t;
+
+/**
+ * Ein Messzeitpunkt eines Treibers (32 Byte inkl. Ausrichtung).
+ */
+typedef struct {
+    int64_t t_unix_us;                  // Wanduhrzeit (NTP) zu Messbeginn; 0 ohne gültige Zeit
+    uint8_t sensor;                     // Index im Register
+    uint8_t n_values;                   // = n_channels des Treibers
+    uint8_t valid;                      // Bit i = values[i] gültig
+    uint8_t reserved;
+    float values[SENSOR_MAX_CHANNELS];  // in der Einheit des Kanals
+} sensor_record_t;
+
+/**
+ * Treiberbeschreibung; muss bis zum Neustart gültig bleiben (üblicherweise static const).
+ */
+typedef struct {
+    const char *name;                   // Kennung im Log, z. B. "sgp30"; höchstens SENSOR_NAME_MAX_LEN
+    uint8_t caps;                       // sensor_cap_t
+    uint8_t n_channels;                 // 1..SENSOR_MAX_CHANNELS
+    const sensor_channel_t *channels;
+    uint32_t period_ms;                 // Abtastperiode
+
+    /**
+     * Einmalig im Sensor-Task, nach sensor_bus_init(). Bei Fehler bleibt der Treiber inaktiv.
+     */
+    esp_err_t (*init)(void);
+
+    /**
+     * Nur mit SENSOR_CAP_ASYNC: Messung anstoßen, ohne auf das Ergebnis zu warten.
+     *
+     * @param ready_in_us Ziel für die Zeit bis zum frühesten Auslesen.
+     */
+    esp_err_t (*start)(uint32_t *ready_in_us);
+
+    /**
+     * Messwerte in rec->values eintragen und gültige in rec->valid markieren; t_unix_us, sensor
+     * und n_values sind bereits gesetzt. Ohne SENSOR_CAP_ASYNC misst read() vollständig.
+     */
+    esp_err_t (*read)(sensor_record_t *rec);
+} sensor_driver_t;
+
+/**
+ * Statistik eines Kanals über ein Fenster; bei n == 0 sind min/max/sum ohne Aussage.
+ */
+typedef struct {
+    float min;
+    float max;
+    float sum;
+    uint32_t n;
+} sensor_stat_t;
+
+/**
+ * Alle Kanäle aller Treiber eines Publish-Fensters, indiziert wie sensor_get() und
+ * sensor_driver_t::channels.
+ */
+typedef struct {
+    sensor_stat_t stat[SENSOR_MAX_DRIVERS][SENSOR_MAX_CHANNELS];
+    int64_t t_unix_us[SENSOR_MAX_DRIVERS]; // Messbeginn des jüngsten Datensatzes mit Werten; 0 ohne Zeit
+    uint32_t n_records;                    // entnommene Datensätze (auch ohne gültige Werte)
+} sensor_window_t;
+
+/**
+ * @return Mittelwert des Kanals; 0, wenn das Fenster leer ist.
+ */
+static inline float sensor_stat_mean(const sensor_stat_t *s)
+{
+    return s->n ? s->sum / (float)s->n : 0.0f;
+}
+
+/**
+ * Trägt einen Treiber ins Register ein. Nur vor sensor_registry_init() aufrufen.
+ *
+ * @param drv Treiberbeschreibung (wird nicht kopiert).
+ * @return ESP_OK bei Erfolg,
+ *         ESP_ERR_INVALID_ARG bei unvollständiger Beschreibung (read, Kanäle, Periode, start bei ASYNC)
+ *         oder zu langen Namen bzw. zu vielen Nachkommastellen,
+ *         ESP_ERR_INVALID_STATE nach sensor_registry_init(),
+ *         ESP_ERR_NO_MEM, wenn bereits SENSOR_MAX_DRIVERS eingetragen sind.
+ */
+esp_err_t sensor_register(const sensor_driver_t *drv);
+
+/**
+ * Initialisiert alle eingetragenen Treiber; fehlgeschlagene bleiben inaktiv, behalten aber
+ * ihren Index. Voraussetzung: Sensorbus initialisiert.
+ *
+ * @return ESP_OK, wenn mindestens ein Treiber aktiv ist, sonst ESP_ERR_NOT_FOUND.
+ */
+esp_err_t sensor_registry_init(void);
+
+/**
+ * @return Anzahl eingetragener Treiber (aktive und inaktive).
+ */
+size_t sensor_count(void);
+
+/**
+ * @param idx Index im Register (Reihenfolge der Eintragung).
+ * @return Treiberbeschreibung oder NULL bei ungültigem Index.
+ */
+const sensor_driver_t *sensor_get(size_t idx);
+
+/**
+ * Abtast-Task: fragt jeden aktiven Treiber im Takt seiner period_ms ab. Fällige ASYNC-Treiber
+ * werden gemeinsam gestartet und in der Reihenfolge ihrer Fertigzeit ausgelesen, sodass sich
+ * die Konvertierungen überlappen. Jeder Datensatz landet im Ring.
+ *
+ * Einziger Producer des Rings. Voraussetzung: sensor_registry_init().
+ *
+ * @param args Nicht verwendet.
+ */
+[[noreturn]] void sensor_sampler_task(void *args);
+
+/**
+ * Legt einen Datensatz im Ring ab; ist er voll, wird der Datensatz verworfen und gezählt
+ * (sensor_ring_drops()). Der Ring hält höchstens SENSOR_RING_DEPTH Datensätze.
+ *
+ * Einziger Producer ist sensor_sampler_task(); direkt nur aufrufen, wenn der Sampler nicht läuft
+ * (Host-Tests).
+ *
+ * @param rec Datensatz (wird kopiert).
+ */
+void sensor_ring_push(const sensor_record_t *rec);
+
+/**
+ * Entnimmt alle Datensätze aus dem Ring und fasst sie je Treiber und Kanal zusammen.
+ *
+ * Einziger Consumer des Rings; lockfrei gegenüber sensor_sampler_task().
+ *
+ * @param out Ziel für die Statistik (wird überschrieben).
+ * @return Anzahl entnommener Datensätze.
+ */
+size_t sensor_window_collect(sensor_window_t *out);
+
+/**
+ * @return Datensätze, die seit dem Start verworfen wurden, weil der Ring voll war.
+ */
+uint32_t sensor_ring_drops(void);
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,44 @@
+#ifndef SENSOR_TELEMETRY_H
+#define SENSOR_TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_registry.h"
+
+// Kodierung der Sensorfenster im InfluxDB Line Protocol (Measurement "sensor", Tag sensor=<Treiber>).
+// Nur Formatierung, kein MQTT; läuft daher auch im Host-Build (pio test -e native).
+
+// Längste Zeile aus den Grenzen des Registers (Namen, Nachkommastellen, Kanäle). Werte mit mehr
+// als 7 Vorkommastellen sind nicht eingerechnet; passt eine Zeile nicht, meldet der Encoder -1.
+#define SENSOR_TELEMETRY_VALUE_MAX_LEN   (1 + 7 + 1 + SENSOR_MAX_DECIMALS)  // "-9999999.999"
+#define SENSOR_TELEMETRY_COUNT_MAX_LEN   10                                 // n als uint32_t
+#define SENSOR_TELEMETRY_STAMP_MAX_LEN   (1 + 19 + 3)                       // " " + int64-µs + "000"
+// "<sep><k>=<v>,<k>_min=<v>,<k>_max=<v>,<k>_n=<n>i": 19 feste Zeichen
+#define SENSOR_TELEMETRY_FIELDS_MAX_LEN  (19 + 4 * SENSOR_NAME_MAX_LEN + 3 * SENSOR_TELEMETRY_VALUE_MAX_LEN + \
+                                          SENSOR_TELEMETRY_COUNT_MAX_LEN)
+// "sensor,sensor=<Treiber>" + Kanäle + Zeitstempel + '\n' + Nullterminator
+#define SENSOR_TELEMETRY_LINE_MAX_LEN    (14 + SENSOR_NAME_MAX_LEN + \
+                                          SENSOR_MAX_CHANNELS * SENSOR_TELEMETRY_FIELDS_MAX_LEN + \
+                                          SENSOR_TELEMETRY_STAMP_MAX_LEN + 2)
+
+/**
+ * Kodiert die Kanäle eines Treibers aus einem Fenster als eine Zeile:
+ *
+ *   sensor,sensor=<Treiber> <Kanal>=<Mittel>,<Kanal>_min=..,<Kanal>_max=..,<Kanal>_n=<n>i[,...] [<ns>]\n
+ *
+ * Kanäle ohne Werte (n == 0) fehlen, die übrigen stehen in der Reihenfolge von drv->channels mit
+ * deren Nachkommastellen. Der Zeitstempel ist der Messbeginn in ns; ohne NTP-Zeit (t_unix_us == 0)
+ * fehlt er und Telegraf stempelt beim Empfang. Treiber- und Kanalnamen sind Bezeichner und werden
+ * nicht escaped. Bei Erfolg ist buf nullterminiert.
+ *
+ * @param buf       Ziel der Zeile.
+ * @param size      Größe von buf inkl. Nullterminator.
+ * @param drv       Treiberbeschreibung (Name, Kanäle).
+ * @param stat      Statistik je Kanal, indiziert wie drv->channels.
+ * @param t_unix_us Wanduhrzeit in µs oder 0.
+ * @return Länge inkl. '\n'; 0, wenn kein Kanal Werte hat; -1, wenn buf nicht reicht.
+ */
+int sensor_telemetry_format_line(char *buf, size_t size, const sensor_driver_t *drv,
+                                 const sensor_stat_t *stat, int64_t t_unix_us);
+
+#endif // SENSOR_TELEMETRY_H
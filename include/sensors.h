@@ -1,47 +1,58 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
-#include "driver/i2c.h"
 #include "bmx280.h"
 #include "SGP30.h"
+#include "sensor_registry.h"
 
-#define WRITE_BIT I2C_MASTER_WRITE              /*!< I2C master write */
-#define READ_BIT I2C_MASTER_READ                /*!< I2C master read */
-#define ACK_CHECK_EN 0x1                        /*!< I2C master will check ack from slave*/
-#define ACK_CHECK_DIS 0x0                       /*!< I2C master will not check ack from slave */
-#define ACK_VAL 0x0                             /*!< I2C ack value */
-#define NACK_VAL 0x1                            /*!< I2C nack value */
+// SGP30-Baseline: Der Sensor lernt sie über 12 h; ohne Wiederherstellung beginnt das nach jedem
+// Neustart von vorn. Gespeichert wird mit Wanduhrzeit, wiederhergestellt nur, wenn sie frisch ist.
+#define SGP30_INIT_PHASE_MS           15000                // nach IAQ-Init liefert der Sensor feste Werte (400 ppm / 0 ppb)
+#define SGP30_BASELINE_LEARN_S        (12 * 3600)          // ohne gespeicherte Baseline erst danach sichern
+#define SGP30_BASELINE_SAVE_INTERVAL_S 3600                // Sicherungsintervall
+#define SGP30_BASELINE_MAX_AGE_S      (7 * 24 * 3600)      // älter verwirft das Datenblatt
+#define SGP30_BASELINE_NVS_NAMESPACE  "sgp30"
+#define SGP30_BASELINE_NVS_KEY        "baseline"
+#define SGP30_BASELINE_VERSION        1                    // bei Änderung des Datensatzes erhöhen
 
-/**
- * Global ausgewählter I2C-Port für den Master.
- * Wird in i2c_master_driver_initialize() konfiguriert.
- */
-extern i2c_port_t i2c_num;
+// Abtastperioden der Treiber: SGP30 mit 1 Hz (Takt, den sein Baseline-Algorithmus erwartet),
+// der BMX280 seltener, Temperatur und Luftdruck ändern sich langsam
+#ifndef SGP30_SAMPLE_PERIOD_MS
+#define SGP30_SAMPLE_PERIOD_MS  1000
+#endif
+#ifndef BMX280_SAMPLE_PERIOD_MS
+#define BMX280_SAMPLE_PERIOD_MS 2000
+#endif
+#ifndef BMX280_HUMIDITY
+#define BMX280_HUMIDITY         0    // verbaut ist ein BMP280 ohne Feuchtesensor
+#endif
 
 /**
- * Globale Instanz des SGP30-Sensor-Handles.
- * Nach sensor_sgp30_init() initialisiert und einsatzbereit.
+ * SGP30 (Kanäle tvoc [ppb], eco2 [ppm]); asynchron über den Bus-Task, mit Anlaufphase.
+ * Stellt die gesicherte Baseline im ersten Messzyklus mit gültiger NTP-Zeit wieder her, solange
+ * der Sensor noch keine eigene gelernt hat, und sichert nach jeder Messung bei Bedarf
+ * (sensor_sgp30_checkpoint_baseline()).
  */
-extern sgp30_dev_t main_sgp30_sensor;
+extern const sensor_driver_t sensor_driver_sgp30;
 
 /**
- * Globale Handle-Pointer-Referenz für BMX280 (BME280/BMP280).
- * Nach sensor_bmx280_init() erstellt/konfiguriert.
+ * BMX280 (Kanäle temperature [°C], pressure [hPa], mit BMX280_HUMIDITY auch humidity [%]);
+ * Forced-Messung, ausgelesen nach der berechneten Konvertierungszeit.
  */
-extern bmx280_t* bmx280;
+extern const sensor_driver_t sensor_driver_bmx280;
 
 /**
- * Initialisiert den I2C-Master-Treiber.
+ * Initialisiert den Sensorbus (i2c_master-Treiber, siehe sensor_bus.h).
  *
- * Konfiguriert SDA/SCL, Pull-Ups und Busfrequenz und installiert den
- * Treiber für den in i2c_num gewählten Port.
+ * Konfiguriert SDA/SCL, Pull-Ups und Port aus CONFIG_I2C_MASTER_* und startet
+ * den Bus-Task für asynchrone Transaktionen.
  *
- * @return ESP_OK bei Erfolg, sonst Fehlercode von i2c_driver_install().
+ * @return ESP_OK bei Erfolg, sonst Fehlercode von sensor_bus_init().
  */
 esp_err_t i2c_master_driver_initialize(void);
 
 /**
- * Generische I2C-Lesefunktion (Callback-kompatibel für Sensor-Treiber).
+ * Generische I2C-Lesefunktion (Callback-kompatibel für Sensor-Treiber), synchron über sensor_bus_transfer().
  *
  * Liest len Bytes ab der Registeradresse reg_addr vom Slave unter der
  * Adresse, die via intf_ptr übergeben wurde (z. B. dev->intf_ptr).
@@ -53,12 +64,13 @@ esp_err_t i2c_master_driver_initialize(void);
  * @param reg_data  Ausgabepuffer.
  * @param len       Anzahl der zu lesenden Bytes.
  * @param intf_ptr  Zeiger auf die 7-bit Slave-Adresse (uint8_t*).
- * @return 0/ESP_OK bei Erfolg, sonst Fehlercode von i2c_master_cmd_begin().
+ * @return 0 bei Erfolg, -1 bei Fehler (Busfehler, Timeout, fehlendes Gerät).
  */
 int8_t main_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
 
 /**
- * Generische I2C-Schreibfunktion (Callback-kompatibel für Sensor-Treiber).
+ * Generische I2C-Schreibfunktion (Callback-kompatibel für Sensor-Treiber), synchron über sensor_bus_transfer().
+ * Registerbyte plus Nutzdaten dürfen höchstens SENSOR_BUS_TX_MAX Bytes lang sein.
  *
  * Schreibt len Bytes an die Registeradresse reg_addr des Slaves unter der
  * Adresse, die via intf_ptr übergeben wurde (z. B. dev->intf_ptr).
@@ -70,27 +82,24 @@ int8_t main_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *in
  * @param reg_data  Eingabepuffer mit zu schreibenden Daten.
  * @param len       Anzahl der zu schreibenden Bytes.
  * @param intf_ptr  Zeiger auf die 7-bit Slave-Adresse (uint8_t*).
- * @return 0/ESP_OK bei Erfolg, sonst Fehlercode von i2c_master_cmd_begin().
+ * @return 0 bei Erfolg, -1 bei Fehler (Busfehler, Timeout, fehlendes Gerät).
  */
 int8_t main_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
 
 /**
- * Initialisiert den SGP30-Luftqualitätssensor.
- *
- * - Bindet die generischen I2C-Callbacks ein.
- * - Führt eine Anlauf-Kalibrierung (IAQ) durch und protokolliert Baselines.
- * Nach Abschluss sind eCO2/TVOC-Messungen über main_sgp30_sensor verfügbar.
+ * @return true, sobald die Anlaufphase nach dem IAQ-Init (init() von sensor_driver_sgp30)
+ *         vorbei ist und eCO2/TVOC echte Messwerte sind.
  */
-void sensor_sgp30_init();
+bool sensor_sgp30_ready(void);
 
 /**
- * Erstellt und konfiguriert den BMX280-Treiber (BME280/BMP280).
+ * Sichert die aktuelle Baseline, wenn sie gültig ist (wiederhergestellt oder
+ * SGP30_BASELINE_LEARN_S gelernt) und die letzte Sicherung mindestens
+ * SGP30_BASELINE_SAVE_INTERVAL_S zurückliegt. Ruft der Treiber nach jeder Messung auf.
  *
- * - Erzeugt die Treiberinstanz auf dem I2C-Bus.
- * - Lädt Kalibrierung, setzt Standardkonfiguration (IIR, Standby).
- * - Versetzt den Sensor abschließend in den Schlafmodus (BMX280_MODE_SLEEP).
- * Nach Bedarf kann der Modus später auf FORCED/NORMAL geändert werden.
+ * @return ESP_OK, wenn gesichert wurde oder noch nichts fällig ist,
+ *         sonst Fehler von nvs_open()/nvs_set_blob()/nvs_commit().
  */
-void sensor_bmx280_init();
+esp_err_t sensor_sgp30_checkpoint_baseline(void);
 
-#endif // SENSORS_H
\ No newline at end of file
+#endif // SENSORS_H
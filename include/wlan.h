@@ -4,13 +4,40 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 #include "esp_event.h"
+#include "esp_err.h"
+
+/**
+ * Kanal für ESPNOW, solange der STA nicht mit einem AP verbunden ist (Start, AP nicht
+ * erreichbar). An Controller und Auto identisch setzen.
+ */
+#ifndef WLAN_ESPNOW_CHANNEL
+#define WLAN_ESPNOW_CHANNEL 1
+#endif
+
+/** Höchster erlaubter Kanal (ETSI: 1..13). */
+#ifndef WLAN_CHANNEL_MAX
+#define WLAN_CHANNEL_MAX 13
+#endif
+
+/**
+ * Wartezeit vor einem erneuten Verbindungsversuch; verdoppelt sich bei jedem Fehlschlag
+ * bis WLAN_RECONNECT_MAX_MS und wird nach erfolgreicher IP-Zuweisung zurückgesetzt.
+ */
+#ifndef WLAN_RECONNECT_MIN_MS
+#define WLAN_RECONNECT_MIN_MS 1000
+#endif
+#ifndef WLAN_RECONNECT_MAX_MS
+#define WLAN_RECONNECT_MAX_MS 60000
+#endif
 
 /**
  * Zentraler Event-Handler für Wi-Fi/IP-Ereignisse im STA-Modus.
  *
  * Reagiert u. a. auf:
- * - WIFI_EVENT_STA_START: startet Verbindungsaufbau (esp_wifi_connect)
- * - WIFI_EVENT_STA_DISCONNECTED: setzt Reconnect an und löscht Verbindungs-Flag
+ * - WIFI_EVENT_STA_START: stellt den ESPNOW-Kanal ein und startet den Verbindungsaufbau
+ * - WIFI_EVENT_STA_CONNECTED: merkt sich, dass der Kanal jetzt vom AP vorgegeben wird
+ * - WIFI_EVENT_STA_DISCONNECTED: löscht Verbindungs-Flag, kehrt auf den eigenen Kanal zurück
+ *   und plant einen neuen Versuch mit Backoff
  * - IP_EVENT_STA_GOT_IP: setzt Verbindungs-Flag nach erfolgreicher IP-Zuweisung
  *
  * @param arg        Benutzerargument (nicht verwendet).
@@ -63,11 +90,34 @@ void initSTA(void);
 /**
  * Blockiert bis der STA eine IP erhalten hat oder das Timeout erreicht ist.
  *
- * Voraussetzung: initSTA() wurde vorher aufgerufen.
+ * Voraussetzung: initSTA() wurde vorher aufgerufen. Besteht die Verbindung bereits,
+ * kehrt der Aufruf sofort zurück; das Flag wird nur bei einer Trennung gelöscht.
  *
  * @param timeout Maximale Wartezeit in OS-Ticks (portMAX_DELAY für unbegrenzt).
  * @return true, wenn innerhalb des Timeouts verbunden (IP erhalten); sonst false.
  */
 bool waitForSTAConnected(TickType_t timeout);
 
+/**
+ * @return true, solange der STA mit einem AP assoziiert ist (der Kanal ist dann vom AP
+ *         vorgegeben und kann nicht gewechselt werden).
+ */
+bool wlan_sta_associated(void);
+
+/**
+ * @return Aktueller Primärkanal des Funkmoduls; 0, wenn Wi-Fi nicht läuft.
+ */
+uint8_t wlan_get_channel(void);
+
+/**
+ * Wechselt den Funkkanal (für ESPNOW) und merkt ihn als Kanal für Zeiten ohne AP-Verbindung.
+ *
+ * Voraussetzung: initSTA() wurde vorher aufgerufen.
+ *
+ * @param channel Kanal 1..WLAN_CHANNEL_MAX.
+ * @return ESP_OK; ESP_ERR_INVALID_STATE, wenn der STA assoziiert ist; ESP_ERR_INVALID_ARG bei
+ *         ungültigem Kanal; sonst Fehler von esp_wifi_set_channel (z. B. während eines Scans).
+ */
+esp_err_t wlan_set_channel(uint8_t channel);
+
 #endif // WLAN_H
@@ -0,0 +1,83 @@
+#include "boot.h"
+
+#include <stdio.h>
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "Boot";
+
+#define BOOT_STAGE_COUNT 11
+
+static const char *const s_stage_names[BOOT_STAGE_COUNT] = {
+    "nvs", "motor", "wifi_started", "espnow", "role", "drivable",
+    "net", "time", "mqtt", "sensors", "first_publish"
+};
+
+static struct {
+    EventGroupHandle_t events;
+    SemaphoreHandle_t lock;           // schützt done_ms gegen gleichzeitige Abschlüsse
+    int32_t done_ms[BOOT_STAGE_COUNT]; // -1 = offen
+} g_ctx;
+
+static size_t stage_index(const boot_stage_t stage)
+{
+    return (size_t)__builtin_ctz((unsigned)stage);
+}
+
+void boot_init(void)
+{
+    if (g_ctx.events) return;
+    g_ctx.events = xEventGroupCreate();
+    g_ctx.lock = xSemaphoreCreateMutex();
+    for (size_t i = 0; i < BOOT_STAGE_COUNT; ++i) g_ctx.done_ms[i] = -1;
+}
+
+void boot_stage_done(const boot_stage_t stage)
+{
+    const size_t idx = stage_index(stage);
+    if (!g_ctx.events || idx >= BOOT_STAGE_COUNT) return;
+
+    xSemaphoreTake(g_ctx.lock, portMAX_DELAY);
+    const bool first = g_ctx.done_ms[idx] < 0;
+    if (first) g_ctx.done_ms[idx] = (int32_t)(esp_timer_get_time() / 1000);
+    xSemaphoreGive(g_ctx.lock);
+    if (!first) return;
+
+    xEventGroupSetBits(g_ctx.events, (EventBits_t)stage);
+    ESP_LOGI(TAG, "%s nach %ld ms", s_stage_names[idx], (long)g_ctx.done_ms[idx]);
+}
+
+bool boot_wait(const EventBits_t stages, const TickType_t timeout)
+{
+    if (!g_ctx.events) return false;
+    const EventBits_t bits = xEventGroupWaitBits(g_ctx.events, stages, pdFALSE, pdTRUE, timeout);
+    return (bits & stages) == stages;
+}
+
+bool boot_stage_is_done(const boot_stage_t stage)
+{
+    return g_ctx.events && (xEventGroupGetBits(g_ctx.events) & (EventBits_t)stage) != 0;
+}
+
+int32_t boot_stage_ms(const boot_stage_t stage)
+{
+    const size_t idx = stage_index(stage);
+    if (!g_ctx.events || idx >= BOOT_STAGE_COUNT) return -1;
+    xSemaphoreTake(g_ctx.lock, portMAX_DELAY);
+    const int32_t ms = g_ctx.done_ms[idx];
+    xSemaphoreGive(g_ctx.lock);
+    return ms;
+}
+
+void boot_log_summary(void)
+{
+    char line[256];
+    int n = 0;
+    for (size_t i = 0; i < BOOT_STAGE_COUNT && n >= 0 && (size_t)n < sizeof(line); ++i) {
+        const int32_t ms = boot_stage_ms((boot_stage_t)(1u << i));
+        if (ms < 0) n += snprintf(line + n, sizeof(line) - n, " %s=-", s_stage_names[i]);
+        else n += snprintf(line + n, sizeof(line) - n, " %s=%ld", s_stage_names[i], (long)ms);
+    }
+    ESP_LOGI(TAG, "Startzeiten [ms]:%s", line);
+}
@@ -3,17 +3,22 @@
 //
 
 #include <string.h>
-#include <stdlib.h>
 #include <inttypes.h>
 
+#include <stdatomic.h>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "esp_log.h"
 #include "esp_mac.h"
 #include "esp_now.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 
 #include "../include/espnow.h"
 
@@ -25,23 +30,114 @@
 #define ESPNOW_FRAGMENT_PAYLOAD 200
 #endif
 
+// Frame-Typ im ersten Byte jedes ESPNOW-Frames
+typedef enum : uint8_t {
+    ESPNOW_FRAME_FRAG   = 1, // Fragment einer Nachricht, läuft über die Reassembly
+    ESPNOW_FRAME_SINGLE = 2, // Unfragmentierte Nachricht, geht ohne Lock/Slot direkt an den Callback
+    ESPNOW_FRAME_NACK   = 3, // Empfangsbitmap einer zuverlässigen Nachricht (Empfänger -> Sender)
+    ESPNOW_FRAME_POLL   = 4  // Statusanfrage des Senders, falls Poll-Fragment oder NACK verloren ging
+} espnow_frame_type_t;
+
+// Flags im Fragment-Header
+#define ESPNOW_FRAG_FLAG_RELIABLE 0x01 // Empfänger quittiert per NACK-Bitmap
+#define ESPNOW_FRAG_FLAG_POLL     0x02 // Letztes Fragment einer Senderunde: Empfänger antwortet sofort
+
+// Flags im NACK-Frame
+#define ESPNOW_NACK_FLAG_COMPLETE 0x01 // Nachricht vollständig empfangen und zugestellt
+
 // Protokoll-Header für Fragmentierung
 typedef struct __attribute__((packed)) {
+    uint8_t  type;        // ESPNOW_FRAME_FRAG
+    uint8_t  flags;       // reserviert
     uint16_t msg_id;      // Nachrichten-ID (Sender-seitig vergeben)
     uint16_t seq_idx;     // 0..total_frags-1
     uint16_t total_frags; // Gesamtanzahl Fragmente
     uint16_t payload_len; // Länge der Nutzlast in diesem Fragment
 } espnow_pkt_hdr_t;
 
+// Header für unfragmentierte Nachrichten (Steuerframes etc.), Länge ergibt sich aus der Framelänge
+typedef struct __attribute__((packed)) {
+    uint8_t type;         // ESPNOW_FRAME_SINGLE
+} espnow_single_hdr_t;
+
+// NACK: Bitmap der bereits empfangenen Fragmente (0-Bits = fehlend), Länge (total_frags + 7) / 8
+typedef struct __attribute__((packed)) {
+    uint8_t  type;        // ESPNOW_FRAME_NACK
+    uint8_t  flags;       // ESPNOW_NACK_FLAG_*
+    uint16_t msg_id;
+    uint16_t total_frags;
+} espnow_nack_hdr_t;
+
+// POLL: fordert einen NACK für msg_id an
+typedef struct __attribute__((packed)) {
+    uint8_t  type;        // ESPNOW_FRAME_POLL
+    uint8_t  flags;       // reserviert
+    uint16_t msg_id;
+    uint16_t total_frags;
+} espnow_poll_hdr_t;
+
+// Sendefenster: maximal so viele Frames ohne Statusrückmeldung von esp_now_send unterwegs
+#ifndef ESPNOW_TX_WINDOW
+#define ESPNOW_TX_WINDOW 8
+#endif
+
+// Wartezeit auf einen freien Fensterplatz, danach wird ohne Credit gesendet (verlorene Callbacks)
+#ifndef ESPNOW_TX_CREDIT_TIMEOUT_MS
+#define ESPNOW_TX_CREDIT_TIMEOUT_MS 200
+#endif
+
+// Offene Sendelatenz-Messungen gelten danach als verloren (Sende-Callback ausgeblieben)
+#ifndef ESPNOW_SEND_MARK_TIMEOUT_MS
+#define ESPNOW_SEND_MARK_TIMEOUT_MS 1000
+#endif
+
+// Wiederholungen, wenn der Treiberpuffer trotz Credit voll ist (ESP_ERR_ESPNOW_NO_MEM)
+#ifndef ESPNOW_TX_NOMEM_RETRIES
+#define ESPNOW_TX_NOMEM_RETRIES 10
+#endif
+
+// Wartezeit auf einen NACK nach einer Senderunde
+#ifndef ESPNOW_RELIABLE_ACK_TIMEOUT_MS
+#define ESPNOW_RELIABLE_ACK_TIMEOUT_MS 100
+#endif
+
+// Maximale Anzahl Senderunden (Erstversand + Wiederholungen/Polls) je zuverlässiger Nachricht
+#ifndef ESPNOW_RELIABLE_MAX_ROUNDS
+#define ESPNOW_RELIABLE_MAX_ROUNDS 8
+#endif
+
+// Anzahl zuletzt vollständig empfangener zuverlässiger Nachrichten, die wir uns für späte Polls merken
+#ifndef ESPNOW_RELIABLE_DONE_CACHE
+#define ESPNOW_RELIABLE_DONE_CACHE 8
+#endif
+
+// Größte Nachricht, die in einen einzelnen Frame passt
+#define ESPNOW_SINGLE_MAX_PAYLOAD (ESP_NOW_MAX_DATA_LEN - sizeof(espnow_single_hdr_t))
+
+// Auftrag in der TX-Warteschlange (ein oder mehrere Ziele). Kleine Nachrichten werden in den Auftrag kopiert,
+// größere referenzieren den Puffer des Aufrufers bis zum Abschluss-Callback.
+typedef struct {
+    uint8_t peers[ESPNOW_MAX_FANOUT][6];
+    uint8_t n_peers;
+    int64_t enqueued_us;
+    const uint8_t* data;
+    size_t len;
+    espnow_send_done_cb_t done_cb;
+    void* user_ctx;
+    uint8_t inline_data[ESPNOW_SINGLE_MAX_PAYLOAD];
+} espnow_tx_job_t;
+
 typedef struct {
     bool used;
+    bool delivering;          // Nachricht vollständig, Callback läuft gerade auf dem Puffer
+    bool reliable;            // Sender erwartet NACK-Bitmaps
     uint8_t src_mac[6];
     uint16_t msg_id;
     uint16_t total_frags;
     uint16_t received_frags;
     size_t total_bytes;       // Summe payload_len aller Fragmente
-    uint8_t* buffer;          // Zielspeicher für reassemblierten Payload
-    size_t buffer_size;
+    uint32_t last_ms;         // Zeitpunkt des letzten angenommenen Fragments (Timeout + LRU)
+    uint8_t* buffer;          // Slab-Block, in den die Fragmente direkt an ihre Endposition geschrieben werden
     // Einfaches Bitmap, maximal 512 Fragmente (für ~100 kB bei 200B Payload)
     // Begrenzen wir auf 128 Fragmente (25.6 kB), um RAM zu schonen:
 #ifndef ESPNOW_MAX_FRAGMENTS
@@ -50,19 +146,174 @@ typedef struct {
     uint8_t frag_bitmap[(ESPNOW_MAX_FRAGMENTS + 7) / 8];
 } espnow_reasm_t;
 
+// Statischer Slab-Pool für Reassembly-Puffer: ein Block je gleichzeitig laufender Nachricht.
+// Ersetzt malloc/free im Wi-Fi-Callback und verhindert Heap-Fragmentierung im Dauerbetrieb.
+_Static_assert(ESPNOW_MAX_INFLIGHT_MESSAGES <= 32, "slab free mask is 32 bit wide");
+static uint8_t s_reasm_slab[ESPNOW_MAX_INFLIGHT_MESSAGES][ESPNOW_MAX_MESSAGE_SIZE];
+
+// Empfangsring für ESPNOW_DISPATCH_TASK: Rohframes vom Wi-Fi-Task (einziger Producer)
+// an die Worker-Task (einziger Consumer). Tiefe muss eine Zweierpotenz sein.
+#ifndef ESPNOW_RX_RING_DEPTH
+#define ESPNOW_RX_RING_DEPTH 16
+#endif
+_Static_assert((ESPNOW_RX_RING_DEPTH & (ESPNOW_RX_RING_DEPTH - 1)) == 0, "ring depth must be a power of two");
+
+typedef struct {
+    uint8_t src_mac[6];
+    uint16_t len;
+    uint32_t rx_ms;           // Empfangszeitpunkt für last_seen_ms
+    int8_t rssi;
+    bool has_rssi;
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} espnow_rx_frame_t;
+
+static struct {
+    espnow_rx_frame_t slots[ESPNOW_RX_RING_DEPTH];
+    atomic_uint head;         // nur vom Producer geschrieben
+    atomic_uint tail;         // nur vom Consumer geschrieben
+    atomic_uint drops;        // Frames verworfen, weil der Ring voll war
+} s_rx_ring;
+
+// Sendestatus für ESPNOW_DISPATCH_TASK: Ergebnisse aus dem Send-Callback (Wi-Fi-Task) an die
+// Worker-Task, die sie unter peer_lock in Statistik und Linkqualität einträgt. Mehr als
+// ESPNOW_TX_WINDOW Frames sind nicht gleichzeitig beim Treiber.
+#ifndef ESPNOW_TX_STATUS_RING_DEPTH
+#define ESPNOW_TX_STATUS_RING_DEPTH 16
+#endif
+_Static_assert((ESPNOW_TX_STATUS_RING_DEPTH & (ESPNOW_TX_STATUS_RING_DEPTH - 1)) == 0, "ring depth must be a power of two");
+_Static_assert(ESPNOW_TX_STATUS_RING_DEPTH >= ESPNOW_TX_WINDOW, "status ring must hold a full send window");
+
+typedef struct {
+    uint8_t dst_mac[6];
+    bool ok;
+    int64_t done_us;          // Zeitpunkt des Sende-Callbacks
+} espnow_tx_result_t;
+
+static struct {
+    espnow_tx_result_t slots[ESPNOW_TX_STATUS_RING_DEPTH];
+    atomic_uint head;         // nur vom Producer geschrieben
+    atomic_uint tail;         // nur vom Consumer geschrieben
+    atomic_uint drops;        // Status verworfen, weil der Ring voll war
+} s_tx_status_ring;
+
+// Peer-Register: offene Adressierung mit linearem Sondieren über die MAC.
+// Tabellengröße ist eine Zweierpotenz mit Füllgrad <= 1/2, damit Suchen kurz bleiben.
+#ifndef ESPNOW_PEER_TABLE_SIZE
+#define ESPNOW_PEER_TABLE_SIZE 32
+#endif
+_Static_assert((ESPNOW_PEER_TABLE_SIZE & (ESPNOW_PEER_TABLE_SIZE - 1)) == 0, "peer table size must be a power of two");
+_Static_assert(ESPNOW_PEER_TABLE_SIZE >= 2 * ESPNOW_MAX_PEERS, "peer table load factor must stay <= 1/2");
+
+// Link-Statistik: Zähler werden lockfrei fortgeschrieben, peer_lock schützt nur die
+// Zuordnung MAC -> Block. Der Empfangspfad löst den Block einmal je Frame auf und zählt
+// danach ohne Lock. Ein freigegebener Block wird nicht gleich wieder vergeben, sodass
+// Inkremente im Flug nach einer Verdrängung im alten, unbenutzten Block landen statt
+// beim Nachfolger.
+typedef struct {
+    atomic_uint tx_frames;
+    atomic_uint tx_failed;
+    atomic_uint rx_frames;
+    atomic_uint rx_messages;
+    atomic_uint frags_dropped;
+    atomic_uint reasm_timeouts;
+    atomic_uint dup_frags;
+    atomic_int rssi_q4;       // EWMA in 1/16 dBm, 0 = noch kein Empfang
+    atomic_uint send_latency_hist[ESPNOW_LATENCY_BUCKETS];
+    atomic_uint ack_latency_hist[ESPNOW_LATENCY_BUCKETS];
+} espnow_stats_block_t;
+
+// Offene Latenzmessung einer unzuverlässigen Nachricht: endet mit dem Sende-Callback ihres
+// letzten Frames. Der Treiber meldet Frames in Übergabereihenfolge, daher genügt deren laufende
+// Nummer, sofern jede Meldung mitgezählt wird (auch verworfene). Mehr als ein Sendefenster
+// voller letzter Frames ist nicht gleichzeitig unterwegs.
+typedef struct {
+    bool used;
+    uint8_t mac[6];
+    uint32_t seq;             // Wert von tx_submitted nach dem letzten Frame
+    int64_t start_us;
+    int64_t submit_us;        // Übergabe des letzten Frames, Basis für ESPNOW_SEND_MARK_TIMEOUT_MS
+} espnow_send_mark_t;
+
+// Ein Block mehr als Peers: bei jeder Vergabe ist neben dem zuletzt freigegebenen noch einer frei
+#define ESPNOW_STATS_BLOCKS (ESPNOW_MAX_PEERS + 1)
+_Static_assert(ESPNOW_STATS_BLOCKS <= 32, "peer stats mask is 32 bit wide");
+static const uint32_t s_latency_bounds_ms[ESPNOW_LATENCY_BUCKETS - 1] = ESPNOW_LATENCY_BOUNDS_MS;
+
+typedef struct {
+    bool used;
+    uint8_t stats_idx;        // Index in g_ctx.peer_stats, bleibt beim Verschieben des Slots gleich
+    uint16_t tx_quality;      // Zustellquote als Festkomma, 0..UINT16_MAX = 0..100 %
+    espnow_peer_info_t info;
+} espnow_peer_slot_t;
+
 static struct {
     bool initialized;
     wifi_interface_t ifx;
+    espnow_dispatch_mode_t dispatch;
+    TaskHandle_t worker;
+    SemaphoreHandle_t worker_done;
+    volatile bool worker_stop;
     espnow_recv_cb_t recv_cb;
     void* user_ctx;
     SemaphoreHandle_t lock;
     uint16_t next_msg_id;
+    uint32_t reasm_timeout_ms;
+    uint8_t max_slots_per_peer;
 
     // Reassembly-Slots
     espnow_reasm_t reasm[ESPNOW_MAX_INFLIGHT_MESSAGES];
+    uint32_t slab_used_mask;  // Bit i gesetzt = s_reasm_slab[i] vergeben
+
+    // Sendefenster: ein Credit je Frame, zurückgegeben im esp_now-Sende-Callback
+    SemaphoreHandle_t tx_credits;
+
+    // Asynchroner Versand: begrenzte Warteschlange + Sende-Task
+    QueueHandle_t tx_queue;
+    TaskHandle_t tx_task;
+    SemaphoreHandle_t tx_task_done;
+    volatile bool tx_stop;
+    uint32_t tx_queue_depth;
+    atomic_uint tx_rejected;
+    atomic_uint tx_driver_busy;
+
+    // Latenz bis Sende-Callback; tx_completed und send_marks nur unter peer_lock
+    SemaphoreHandle_t tx_lock; // esp_now_send und Nummernvergabe in einem Schritt
+    uint32_t tx_submitted;    // vom Treiber angenommene Frames, nur unter tx_lock
+    uint32_t tx_completed;    // davon gemeldet (Sende-Callback oder verworfener Status)
+    espnow_send_mark_t send_marks[ESPNOW_TX_WINDOW];
+
+    // Empfängerseite: zuletzt abgeschlossene zuverlässige Nachrichten (Antwort auf späte Polls)
+    struct {
+        uint8_t src_mac[6];
+        uint16_t msg_id;
+    } rel_done[ESPNOW_RELIABLE_DONE_CACHE];
+    uint8_t rel_done_next;
+
+    // Senderseite: genau eine zuverlässige Übertragung gleichzeitig
+    SemaphoreHandle_t rel_lock;
+    SemaphoreHandle_t rel_nack;       // signalisiert eingegangenen NACK
+    struct {
+        bool active;
+        bool complete;
+        uint8_t peer[6];
+        uint16_t msg_id;
+        uint16_t total_frags;
+        uint8_t acked[(ESPNOW_MAX_FRAGMENTS + 7) / 8];
+    } rel_tx;
+
+    // Peer-Register
+    SemaphoreHandle_t peer_lock;
+    espnow_peer_slot_t peers[ESPNOW_PEER_TABLE_SIZE];
+    uint8_t peer_count;
+    espnow_stats_block_t peer_stats[ESPNOW_STATS_BLOCKS];
+    uint32_t peer_stats_used;  // Bit i gesetzt = peer_stats[i] vergeben
+    uint8_t peer_stats_retired; // zuletzt freigegebener Block + 1, 0 = keiner
+    espnow_stats_block_t other_stats;
 
 } g_ctx = {0};
 
+static const uint8_t s_bcast_mac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
 // Hilfsfunktionen
 static void lock(void)   { if (g_ctx.lock) xSemaphoreTake(g_ctx.lock, portMAX_DELAY); }
 static void unlock(void) { if (g_ctx.lock) xSemaphoreGive(g_ctx.lock); }
@@ -71,6 +322,172 @@ static bool mac_equal(const uint8_t a[6], const uint8_t b[6]) {
     return memcmp(a, b, 6) == 0;
 }
 
+static uint32_t now_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+static void peer_lock(void)   { if (g_ctx.peer_lock) xSemaphoreTake(g_ctx.peer_lock, portMAX_DELAY); }
+static void peer_unlock(void) { if (g_ctx.peer_lock) xSemaphoreGive(g_ctx.peer_lock); }
+
+// FNV-1a über alle 6 Bytes; die OUI-Bytes sind bei gleichen Boards identisch
+static uint32_t peer_home(const uint8_t mac[6]) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 6; ++i) {
+        h ^= mac[i];
+        h *= 16777619u;
+    }
+    return h & (ESPNOW_PEER_TABLE_SIZE - 1);
+}
+
+// Aufrufer hält peer_lock
+static espnow_peer_slot_t* peer_find(const uint8_t mac[6]) {
+    uint32_t i = peer_home(mac);
+    for (uint32_t n = 0; n < ESPNOW_PEER_TABLE_SIZE; ++n, i = (i + 1) & (ESPNOW_PEER_TABLE_SIZE - 1)) {
+        espnow_peer_slot_t* s = &g_ctx.peers[i];
+        if (!s->used) return NULL;
+        if (mac_equal(s->info.mac, mac)) return s;
+    }
+    return NULL;
+}
+
+// Aufrufer hält peer_lock und stellt peer_count < ESPNOW_MAX_PEERS sicher
+static espnow_peer_slot_t* peer_insert(const uint8_t mac[6]) {
+    uint32_t i = peer_home(mac);
+    while (g_ctx.peers[i].used) {
+        if (mac_equal(g_ctx.peers[i].info.mac, mac)) return &g_ctx.peers[i];
+        i = (i + 1) & (ESPNOW_PEER_TABLE_SIZE - 1);
+    }
+    espnow_peer_slot_t* s = &g_ctx.peers[i];
+    memset(s, 0, sizeof(*s));
+    s->used = true;
+    memcpy(s->info.mac, mac, 6);
+    g_ctx.peer_count++;
+
+    // peer_count < ESPNOW_MAX_PEERS lässt mindestens zwei Blöcke frei; der zuletzt
+    // freigegebene bleibt liegen, bis ein weiterer Peer geht
+    uint8_t idx = 0;
+    while ((g_ctx.peer_stats_used & (1u << idx)) || idx + 1 == g_ctx.peer_stats_retired) idx++;
+    g_ctx.peer_stats_used |= 1u << idx;
+    s->stats_idx = idx;
+    memset(&g_ctx.peer_stats[idx], 0, sizeof(g_ctx.peer_stats[idx]));
+    return s;
+}
+
+// Entfernen mit Rückwärtsverschiebung statt Grabsteinen, damit Suchketten kurz bleiben.
+// Aufrufer hält peer_lock.
+static void peer_erase(espnow_peer_slot_t* s) {
+    const uint32_t mask = ESPNOW_PEER_TABLE_SIZE - 1;
+    g_ctx.peer_stats_used &= ~(1u << s->stats_idx);
+    g_ctx.peer_stats_retired = (uint8_t)(s->stats_idx + 1);
+    uint32_t hole = (uint32_t)(s - g_ctx.peers);
+    uint32_t j = hole;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!g_ctx.peers[j].used) break;
+        // Eintrag j darf in das Loch rücken, wenn das Loch nicht vor seiner Heimatposition liegt
+        const uint32_t home = peer_home(g_ctx.peers[j].info.mac);
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            g_ctx.peers[hole] = g_ctx.peers[j];
+            hole = j;
+        }
+    }
+    g_ctx.peers[hole].used = false;
+    g_ctx.peer_count--;
+}
+
+// Am längsten nicht gehörter Peer außer exclude; encrypted_only bevorzugt verschlüsselte Peers.
+// Aufrufer hält peer_lock.
+static espnow_peer_slot_t* peer_lru(const uint8_t exclude[6], const bool encrypted_only) {
+    const uint32_t now = now_ms();
+    espnow_peer_slot_t* victim = NULL;
+    for (size_t i = 0; i < ESPNOW_PEER_TABLE_SIZE; ++i) {
+        espnow_peer_slot_t* s = &g_ctx.peers[i];
+        if (!s->used || mac_equal(s->info.mac, exclude)) continue;
+        if (encrypted_only && !s->info.encrypt) continue;
+        if (!victim || now - s->info.last_seen_ms > now - victim->info.last_seen_ms) victim = s;
+    }
+    if (!victim && encrypted_only) return peer_lru(exclude, false);
+    return victim;
+}
+
+// Aufrufer hält peer_lock
+static bool peer_evict(const uint8_t exclude[6], const bool encrypted_only) {
+    espnow_peer_slot_t* victim = peer_lru(exclude, encrypted_only);
+    if (!victim) return false;
+    ESP_LOGW(TAG, "Peer table full, evicting " MACSTR " (idle %" PRIu32 " ms)",
+             MAC2STR(victim->info.mac), now_ms() - victim->info.last_seen_ms);
+    esp_now_del_peer(victim->info.mac);
+    peer_erase(victim);
+    return true;
+}
+
+// Aufrufer hält peer_lock
+static espnow_stats_block_t* stats_of(const espnow_peer_slot_t* peer) {
+    return peer ? &g_ctx.peer_stats[peer->stats_idx] : &g_ctx.other_stats;
+}
+
+#define STAT_INC(st, field) atomic_fetch_add_explicit(&(st)->field, 1, memory_order_relaxed)
+
+// Zählt field im Block eines Absenders/Ziels hoch; nicht registrierte MACs zählen unter "other".
+// Für seltene Ereignisse abseits des Frame-Pfads; dort wird der Block einmal je Frame aufgelöst.
+#define STAT_INC_MAC(mac, field) do {               \
+        peer_lock();                                \
+        STAT_INC(stats_of(peer_find(mac)), field);  \
+        peer_unlock();                              \
+    } while (0)
+
+static size_t latency_bucket(const int64_t elapsed_us) {
+    const uint32_t ms = (uint32_t)(elapsed_us / 1000);
+    size_t bucket = 0;
+    while (bucket < ESPNOW_LATENCY_BUCKETS - 1 && ms >= s_latency_bounds_ms[bucket]) bucket++;
+    return bucket;
+}
+
+static void stats_record_ack_latency(const uint8_t mac[6], const int64_t start_us) {
+    const size_t bucket = latency_bucket(esp_timer_get_time() - start_us);
+    STAT_INC_MAC(mac, ack_latency_hist[bucket]);
+}
+
+// Schließt alle offenen Messungen, deren letzter Frame abgeschlossen ist. Aufrufer hält peer_lock.
+static void send_marks_complete(const int64_t done_us) {
+    // Ist eine Messung überfällig, fehlt ein Sende-Callback: Zähler auf ihren Frame nachziehen,
+    // damit nicht jede spätere Messung einen Frame zu spät endet. Die überfällige zählt nicht.
+    for (size_t i = 0; i < ESPNOW_TX_WINDOW; ++i) {
+        espnow_send_mark_t* m = &g_ctx.send_marks[i];
+        if (!m->used || done_us - m->submit_us <= (int64_t)ESPNOW_SEND_MARK_TIMEOUT_MS * 1000) continue;
+        if ((int32_t)(g_ctx.tx_completed - m->seq) < 0) {
+            ESP_LOGW(TAG, "Send to " MACSTR " not reported after %d ms", MAC2STR(m->mac), ESPNOW_SEND_MARK_TIMEOUT_MS);
+            g_ctx.tx_completed = m->seq;
+        }
+        m->used = false;
+    }
+    for (size_t i = 0; i < ESPNOW_TX_WINDOW; ++i) {
+        espnow_send_mark_t* m = &g_ctx.send_marks[i];
+        if (!m->used || (int32_t)(g_ctx.tx_completed - m->seq) < 0) continue;
+        STAT_INC(stats_of(peer_find(m->mac)), send_latency_hist[latency_bucket(done_us - m->start_us)]);
+        m->used = false;
+    }
+}
+
+// Startet die Messung bis zum Sende-Callback des Frames mit Nummer seq
+static void send_mark_add(const uint8_t mac[6], const uint32_t seq, const int64_t start_us) {
+    const int64_t now = esp_timer_get_time();
+    peer_lock();
+    send_marks_complete(now); // überfällige Einträge freigeben
+    espnow_send_mark_t* free_mark = NULL;
+    for (size_t i = 0; i < ESPNOW_TX_WINDOW && !free_mark; ++i) {
+        if (!g_ctx.send_marks[i].used) free_mark = &g_ctx.send_marks[i];
+    }
+    // Ohne freien Eintrag entfällt die Messung
+    if (free_mark) {
+        *free_mark = (espnow_send_mark_t){.used = true, .seq = seq, .start_us = start_us, .submit_us = now};
+        memcpy(free_mark->mac, mac, 6);
+        // Callback kann schon vor dem Eintrag gebucht worden sein
+        send_marks_complete(now);
+    }
+    peer_unlock();
+}
+
 static void set_bitmap(espnow_reasm_t* r, const uint16_t idx) {
     r->frag_bitmap[idx / 8] |= (uint8_t)(1u << (idx % 8));
 }
@@ -78,55 +495,228 @@ static bool get_bitmap(const espnow_reasm_t* r, const uint16_t idx) {
     return (r->frag_bitmap[idx / 8] >> (idx % 8)) & 1u;
 }
 
-static espnow_reasm_t* reasm_find_or_alloc(const uint8_t src_mac[6], const uint16_t msg_id, const uint16_t total_frags) {
-    // Suchen
-    for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
-        if (g_ctx.reasm[i].used &&
-            g_ctx.reasm[i].msg_id == msg_id &&
-            mac_equal(g_ctx.reasm[i].src_mac, src_mac)) {
-            return &g_ctx.reasm[i];
+// Einzelnen Frame senden; belegt einen Platz im Sendefenster bis zum Sende-Callback.
+// credit_wait = 0 für Antworten aus dem Empfangspfad, die nicht blockieren dürfen.
+// seq_out (optional) erhält die laufende Nummer des Frames in der Sendereihenfolge des Treibers
+// Übergibt einen Frame an den Treiber und nummeriert ihn in derselben Sperre, damit die
+// Nummern der Reihenfolge der Sende-Callbacks entsprechen. Die Sperre umfasst nur den
+// nicht blockierenden Aufruf, nie die Wartezeit bei vollem Treiberpuffer.
+static esp_err_t submit_frame(const uint8_t peer_mac[6], const uint8_t* frame, const size_t len, uint32_t* seq_out) {
+    xSemaphoreTake(g_ctx.tx_lock, portMAX_DELAY);
+    const esp_err_t err = esp_now_send(peer_mac, frame, len);
+    if (err == ESP_OK) {
+        g_ctx.tx_submitted++;
+        if (seq_out) *seq_out = g_ctx.tx_submitted;
+    }
+    xSemaphoreGive(g_ctx.tx_lock);
+    return err;
+}
+
+static esp_err_t send_frame_seq(const uint8_t peer_mac[6], const uint8_t* frame, const size_t len,
+                                const TickType_t credit_wait, uint32_t* seq_out) {
+    const bool credit = xSemaphoreTake(g_ctx.tx_credits, credit_wait) == pdTRUE;
+    if (!credit && credit_wait == 0) return ESP_ERR_TIMEOUT;
+    if (!credit) {
+        ESP_LOGW(TAG, "No TX credit after %d ms, sending anyway", ESPNOW_TX_CREDIT_TIMEOUT_MS);
+    }
+    esp_err_t err = submit_frame(peer_mac, frame, len, seq_out);
+    // Treiberpuffer voll: kurz warten und erneut versuchen statt die Nachricht halb zu senden.
+    // Antworten aus dem Empfangspfad (credit_wait = 0) warten nie.
+    for (int retry = 0; err == ESP_ERR_ESPNOW_NO_MEM && credit_wait != 0 && retry < ESPNOW_TX_NOMEM_RETRIES; ++retry) {
+        atomic_fetch_add_explicit(&g_ctx.tx_driver_busy, 1, memory_order_relaxed);
+        vTaskDelay(1);
+        err = submit_frame(peer_mac, frame, len, seq_out);
+    }
+    if (err != ESP_OK && credit) {
+        xSemaphoreGive(g_ctx.tx_credits);
+    }
+    return err;
+}
+
+static esp_err_t send_frame(const uint8_t peer_mac[6], const uint8_t* frame, const size_t len, const TickType_t credit_wait) {
+    return send_frame_seq(peer_mac, frame, len, credit_wait, NULL);
+}
+
+// Fragment idx von data in frame (mind. sizeof(espnow_pkt_hdr_t) + ESPNOW_FRAGMENT_PAYLOAD) kodieren
+static size_t build_fragment(uint8_t* frame, const uint8_t* data, const size_t len,
+                             const uint16_t msg_id, const uint16_t idx, const uint16_t total_frags,
+                             const uint8_t flags) {
+    const size_t remaining = len - (size_t)idx * ESPNOW_FRAGMENT_PAYLOAD;
+    uint16_t chunk = (uint16_t)((remaining >= ESPNOW_FRAGMENT_PAYLOAD) ? ESPNOW_FRAGMENT_PAYLOAD : remaining);
+    if (len == 0) chunk = 0;
+
+    const espnow_pkt_hdr_t hdr = {
+        .type = ESPNOW_FRAME_FRAG,
+        .flags = flags,
+        .msg_id = msg_id,
+        .seq_idx = idx,
+        .total_frags = total_frags,
+        .payload_len = chunk
+    };
+    memcpy(frame, &hdr, sizeof(hdr));
+    if (chunk > 0) {
+        memcpy(frame + sizeof(hdr), data + (size_t)idx * ESPNOW_FRAGMENT_PAYLOAD, chunk);
+    }
+    return sizeof(hdr) + chunk;
+}
+
+static esp_err_t send_fragment(const uint8_t peer_mac[6], const uint8_t* data, const size_t len,
+                               const uint16_t msg_id, const uint16_t idx, const uint16_t total_frags,
+                               const uint8_t flags) {
+    uint8_t frame[sizeof(espnow_pkt_hdr_t) + ESPNOW_FRAGMENT_PAYLOAD];
+    const size_t frame_len = build_fragment(frame, data, len, msg_id, idx, total_frags, flags);
+    return send_frame(peer_mac, frame, frame_len, pdMS_TO_TICKS(ESPNOW_TX_CREDIT_TIMEOUT_MS));
+}
+
+// Empfängerseite: Bitmap (oder "vollständig") an den Sender zurückmelden
+static void send_nack(const uint8_t peer_mac[6], const uint16_t msg_id, const uint16_t total_frags,
+                      const uint8_t* bitmap, const bool complete) {
+    uint8_t frame[sizeof(espnow_nack_hdr_t) + (ESPNOW_MAX_FRAGMENTS + 7) / 8];
+    const size_t bitmap_len = ((size_t)total_frags + 7) / 8;
+    const espnow_nack_hdr_t hdr = {
+        .type = ESPNOW_FRAME_NACK,
+        .flags = complete ? ESPNOW_NACK_FLAG_COMPLETE : 0,
+        .msg_id = msg_id,
+        .total_frags = total_frags
+    };
+    memcpy(frame, &hdr, sizeof(hdr));
+    if (bitmap) {
+        memcpy(frame + sizeof(hdr), bitmap, bitmap_len);
+    } else {
+        memset(frame + sizeof(hdr), complete ? 0xFF : 0x00, bitmap_len);
+    }
+    // Geht der NACK verloren oder ist das Fenster voll, pollt der Sender erneut
+    (void)send_frame(peer_mac, frame, sizeof(hdr) + bitmap_len, 0);
+}
+
+static void rel_done_remember(const uint8_t src_mac[6], const uint16_t msg_id) {
+    memcpy(g_ctx.rel_done[g_ctx.rel_done_next].src_mac, src_mac, 6);
+    g_ctx.rel_done[g_ctx.rel_done_next].msg_id = msg_id;
+    g_ctx.rel_done_next = (uint8_t)((g_ctx.rel_done_next + 1) % ESPNOW_RELIABLE_DONE_CACHE);
+}
+
+static bool rel_done_contains(const uint8_t src_mac[6], const uint16_t msg_id) {
+    for (int i = 0; i < ESPNOW_RELIABLE_DONE_CACHE; ++i) {
+        if (g_ctx.rel_done[i].msg_id == msg_id && mac_equal(g_ctx.rel_done[i].src_mac, src_mac)) {
+            return true;
         }
     }
-    // Allozieren
+    return false;
+}
+
+static uint8_t* slab_alloc(void) {
     for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
-        if (!g_ctx.reasm[i].used) {
-            espnow_reasm_t* r = &g_ctx.reasm[i];
-            memset(r, 0, sizeof(*r));
-            r->used = true;
-            memcpy(r->src_mac, src_mac, 6);
-            r->msg_id = msg_id;
-            r->total_frags = total_frags;
-            return r;
+        if (!(g_ctx.slab_used_mask & (1u << i))) {
+            g_ctx.slab_used_mask |= (1u << i);
+            return s_reasm_slab[i];
         }
     }
     return NULL;
 }
 
+static void slab_free(const uint8_t* block) {
+    if (!block) return;
+    const size_t idx = (size_t)(block - &s_reasm_slab[0][0]) / ESPNOW_MAX_MESSAGE_SIZE;
+    if (idx < ESPNOW_MAX_INFLIGHT_MESSAGES) {
+        g_ctx.slab_used_mask &= ~(1u << idx);
+    }
+}
+
+static void reasm_free(espnow_reasm_t* r);
+
+// Slots, deren letztes Fragment länger als reasm_timeout_ms zurückliegt, freigeben
+static void reasm_expire(const uint32_t now) {
+    for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+        espnow_reasm_t* r = &g_ctx.reasm[i];
+        if (r->used && !r->delivering && (now - r->last_ms) > g_ctx.reasm_timeout_ms) {
+            ESP_LOGW(TAG, "Reassembly timeout msg=%u from " MACSTR " (%u/%u frags)",
+                     r->msg_id, MAC2STR(r->src_mac), r->received_frags, r->total_frags);
+            STAT_INC_MAC(r->src_mac, reasm_timeouts);
+            reasm_free(r);
+        }
+    }
+}
+
+// Am längsten unbenutzten Slot wählen; src_mac != NULL beschränkt die Suche auf diesen Absender
+static espnow_reasm_t* reasm_lru(const uint8_t* src_mac) {
+    espnow_reasm_t* victim = NULL;
+    for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+        espnow_reasm_t* r = &g_ctx.reasm[i];
+        if (!r->used || r->delivering) continue;
+        if (src_mac && !mac_equal(r->src_mac, src_mac)) continue;
+        if (!victim || (int32_t)(r->last_ms - victim->last_ms) < 0) victim = r;
+    }
+    return victim;
+}
+
+static espnow_reasm_t* reasm_find_or_alloc(const uint8_t src_mac[6], const uint16_t msg_id, const uint16_t total_frags) {
+    // Suchen
+    int held_by_src = 0;
+    for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+        if (!g_ctx.reasm[i].used || !mac_equal(g_ctx.reasm[i].src_mac, src_mac)) continue;
+        if (g_ctx.reasm[i].msg_id == msg_id) return &g_ctx.reasm[i];
+        held_by_src++;
+    }
+
+    const uint32_t now = now_ms();
+    reasm_expire(now);
+
+    // Quote je Absender: ein gesprächiger Peer verdrängt nur seine eigenen Nachrichten
+    espnow_reasm_t* victim = NULL;
+    if (g_ctx.max_slots_per_peer > 0 && held_by_src >= g_ctx.max_slots_per_peer) {
+        victim = reasm_lru(src_mac);
+    }
+    if (!victim) {
+        for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+            if (!g_ctx.reasm[i].used) { victim = &g_ctx.reasm[i]; break; }
+        }
+    }
+    if (!victim) {
+        victim = reasm_lru(NULL);
+    }
+    if (!victim) return NULL; // alle Slots werden gerade zugestellt
+
+    if (victim->used) {
+        ESP_LOGW(TAG, "Evicting reassembly msg=%u from " MACSTR " (%u/%u frags)",
+                 victim->msg_id, MAC2STR(victim->src_mac), victim->received_frags, victim->total_frags);
+        STAT_INC_MAC(victim->src_mac, reasm_timeouts);
+        reasm_free(victim);
+    }
+
+    espnow_reasm_t* r = victim;
+    r->buffer = slab_alloc();
+    if (!r->buffer) return NULL;
+    r->used = true;
+    memcpy(r->src_mac, src_mac, 6);
+    r->msg_id = msg_id;
+    r->total_frags = total_frags;
+    r->last_ms = now;
+    return r;
+}
+
 static void reasm_free(espnow_reasm_t* r) {
     if (!r) return;
-    if (r->buffer) {
-        free(r->buffer);
-    }
+    slab_free(r->buffer);
     memset(r, 0, sizeof(*r));
 }
 
-static void ensure_buffer_for_fragment(espnow_reasm_t* r, const uint16_t seq_idx, const uint16_t payload_len) {
-    // Wir schreiben Fragments payload direkt hintereinander in Reihenfolge seq_idx
-    // Dafür benötigen wir total_frags * max_payload theoretisch. Wir gehen
-    // dynamisch vor, indem wir bei erstem Fragment eine Obergrenze schätzen
-    size_t min_size = (size_t)(seq_idx + 1) * ESPNOW_FRAGMENT_PAYLOAD;
-    if (min_size > ESPNOW_MAX_MESSAGE_SIZE) min_size = ESPNOW_MAX_MESSAGE_SIZE;
-    if (r->buffer == NULL) {
-        size_t alloc = (size_t)r->total_frags * ESPNOW_FRAGMENT_PAYLOAD;
-        if (alloc > ESPNOW_MAX_MESSAGE_SIZE) alloc = ESPNOW_MAX_MESSAGE_SIZE;
-        r->buffer = (uint8_t*)malloc(alloc);
-        r->buffer_size = r->buffer ? alloc : 0;
+static void on_single_recv(const uint8_t src_mac[6], const uint8_t* data, const int len,
+                           espnow_stats_block_t* st) {
+    // Kein Lock, kein Slot: Nutzlast liegt bereits vollständig im Puffer, der Statistikblock
+    // ist schon aufgelöst
+    STAT_INC(st, rx_messages);
+    if (g_ctx.recv_cb) {
+        g_ctx.recv_cb(src_mac, data + sizeof(espnow_single_hdr_t),
+                      (size_t)len - sizeof(espnow_single_hdr_t), g_ctx.user_ctx);
     }
-    (void)payload_len;
 }
 
-static esp_err_t on_data_recv(const esp_now_recv_info_t* recv_info, const uint8_t* data, const int len) {
-    if (!recv_info || !data || len < (int)sizeof(espnow_pkt_hdr_t)) return ESP_OK;
+static void on_fragment_recv(const uint8_t src_mac[6], const uint8_t* data, const int len,
+                             espnow_stats_block_t* st) {
+    if (len < (int)sizeof(espnow_pkt_hdr_t)) {
+        STAT_INC(st, frags_dropped);
+        return;
+    }
 
     espnow_pkt_hdr_t hdr;
     memcpy(&hdr, data, sizeof(hdr));
@@ -134,92 +724,334 @@ static esp_err_t on_data_recv(const esp_now_recv_info_t* recv_info, const uint8_
     // Sanity checks
     if (hdr.total_frags == 0 || hdr.seq_idx >= hdr.total_frags || hdr.total_frags > ESPNOW_MAX_FRAGMENTS) {
         ESP_LOGW(TAG, "Invalid fragment header: msg=%u seq=%u total=%u", hdr.msg_id, hdr.seq_idx, hdr.total_frags);
-        return ESP_OK;
+        STAT_INC(st, frags_dropped);
+        return;
     }
     if (hdr.payload_len + sizeof(hdr) != (uint16_t)len) {
         ESP_LOGW(TAG, "Length mismatch: hdr=%u actual=%d", hdr.payload_len, len);
-        return ESP_OK;
+        STAT_INC(st, frags_dropped);
+        return;
     }
 
-    const uint8_t* src_mac = recv_info->src_addr;
     const uint8_t* payload = data + sizeof(hdr);
 
+    // Alle Fragmente außer dem letzten sind voll belegt, sonst passt die Slab-Position nicht
+    if (hdr.seq_idx + 1 < hdr.total_frags && hdr.payload_len != ESPNOW_FRAGMENT_PAYLOAD) {
+        ESP_LOGW(TAG, "Short non-final fragment: msg=%u seq=%u len=%u", hdr.msg_id, hdr.seq_idx, hdr.payload_len);
+        STAT_INC(st, frags_dropped);
+        return;
+    }
+
+    const bool reliable = (hdr.flags & ESPNOW_FRAG_FLAG_RELIABLE) != 0;
+    const bool poll = (hdr.flags & ESPNOW_FRAG_FLAG_POLL) != 0;
+
     lock();
+    if (reliable && rel_done_contains(src_mac, hdr.msg_id)) {
+        // Wiederholung einer bereits zugestellten Nachricht: unseren COMPLETE-NACK hat der Sender verpasst
+        unlock();
+        STAT_INC(st, dup_frags);
+        if (poll) send_nack(src_mac, hdr.msg_id, hdr.total_frags, NULL, true);
+        return;
+    }
     espnow_reasm_t* r = reasm_find_or_alloc(src_mac, hdr.msg_id, hdr.total_frags);
     if (!r) {
         ESP_LOGW(TAG, "No reassembly slot available");
         unlock();
-        return ESP_OK;
+        STAT_INC(st, frags_dropped);
+        return;
+    }
+    if (r->delivering) {
+        // Duplikat einer Nachricht, deren Callback gerade läuft
+        unlock();
+        STAT_INC(st, dup_frags);
+        return;
     }
     if (r->total_frags != hdr.total_frags) {
         // Konflikt — Nachricht neu beginnen
         reasm_free(r);
         r = reasm_find_or_alloc(src_mac, hdr.msg_id, hdr.total_frags);
-        if (!r) { unlock(); return ESP_OK; }
-    }
-
-    ensure_buffer_for_fragment(r, hdr.seq_idx, hdr.payload_len);
-    if (!r->buffer || r->buffer_size == 0) {
-        ESP_LOGE(TAG, "Out of memory for reassembly");
-        reasm_free(r);
-        unlock();
-        return ESP_OK;
+        if (!r) { unlock(); return; }
     }
 
     if (!get_bitmap(r, hdr.seq_idx)) {
         // Kopiere an Position seq_idx * ESPNOW_FRAGMENT_PAYLOAD
         const size_t offset = (size_t)hdr.seq_idx * (size_t)ESPNOW_FRAGMENT_PAYLOAD;
-        if (offset + hdr.payload_len <= r->buffer_size) {
+        if (offset + hdr.payload_len <= ESPNOW_MAX_MESSAGE_SIZE) {
             memcpy(r->buffer + offset, payload, hdr.payload_len);
+            r->last_ms = now_ms();
             r->received_frags++;
             r->total_bytes += hdr.payload_len;
             set_bitmap(r, hdr.seq_idx);
         } else {
             ESP_LOGW(TAG, "Fragment would overflow buffer");
+            STAT_INC(st, frags_dropped);
         }
+    } else {
+        STAT_INC(st, dup_frags);
     }
+    r->reliable = r->reliable || reliable;
     const bool complete = (r->received_frags == r->total_frags);
-    const size_t total_bytes = r->total_bytes;
-    uint8_t* full = NULL;
+    if (complete) {
+        // Slot bleibt reserviert, bis der Callback den Slab-Block zurückgegeben hat
+        r->delivering = true;
+        if (r->reliable) rel_done_remember(src_mac, r->msg_id);
+    }
+    uint8_t bitmap[sizeof(r->frag_bitmap)];
+    const bool report = r->reliable && (complete || poll);
+    if (report) memcpy(bitmap, r->frag_bitmap, sizeof(bitmap));
+    unlock();
+
+    if (report) {
+        // Sender vor der (ggf. langen) Zustellung freigeben bzw. fehlende Fragmente melden
+        send_nack(src_mac, hdr.msg_id, hdr.total_frags, bitmap, complete);
+    }
 
     if (complete) {
-        full = (uint8_t*)malloc(total_bytes);
-        if (full) {
-            // Zusammensetzen in korrekter Reihenfolge
-            size_t written = 0;
-            for (uint16_t i = 0; i < r->total_frags; ++i) {
-                if (!get_bitmap(r, i)) { written = 0; break; }
-                size_t copy = ESPNOW_FRAGMENT_PAYLOAD;
-                if (i == r->total_frags - 1) {
-                    // Letztes Fragment kann kürzer sein: exakt rekonstruieren
-                    const size_t consumed = (size_t)(r->total_frags - 1) * ESPNOW_FRAGMENT_PAYLOAD;
-                    copy = total_bytes - consumed;
-                }
-                const size_t offset = (size_t)i * (size_t)ESPNOW_FRAGMENT_PAYLOAD;
-                memcpy(full + written, r->buffer + offset, copy);
-                written += copy;
-            }
-        } else {
-            ESP_LOGE(TAG, "Out of memory for final assembly");
+        // Fragmente liegen bereits lückenlos hintereinander: der Slab-Block ist die Nachricht
+        STAT_INC(st, rx_messages);
+        if (g_ctx.recv_cb) {
+            g_ctx.recv_cb(src_mac, r->buffer, r->total_bytes, g_ctx.user_ctx);
         }
+        lock();
         reasm_free(r);
+        unlock();
+    }
+}
+
+static void on_poll_recv(const uint8_t src_mac[6], const uint8_t* data, const int len) {
+    if (len < (int)sizeof(espnow_poll_hdr_t)) return;
+    espnow_poll_hdr_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.total_frags == 0 || hdr.total_frags > ESPNOW_MAX_FRAGMENTS) return;
+
+    uint8_t bitmap[(ESPNOW_MAX_FRAGMENTS + 7) / 8] = {0};
+    bool complete = false;
+
+    lock();
+    if (rel_done_contains(src_mac, hdr.msg_id)) {
+        complete = true;
+    } else {
+        for (int i = 0; i < ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+            const espnow_reasm_t* r = &g_ctx.reasm[i];
+            if (r->used && r->msg_id == hdr.msg_id && mac_equal(r->src_mac, src_mac)) {
+                memcpy(bitmap, r->frag_bitmap, sizeof(bitmap));
+                complete = r->delivering;
+                break;
+            }
+        }
     }
     unlock();
 
-    if (complete && full && g_ctx.recv_cb) {
-        g_ctx.recv_cb(src_mac, full, total_bytes, g_ctx.user_ctx);
+    // Unbekannte Nachricht: leere Bitmap, der Sender wiederholt alles
+    send_nack(src_mac, hdr.msg_id, hdr.total_frags, bitmap, complete);
+}
+
+static void on_nack_recv(const uint8_t src_mac[6], const uint8_t* data, const int len) {
+    if (len < (int)sizeof(espnow_nack_hdr_t)) return;
+    espnow_nack_hdr_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    const size_t bitmap_len = ((size_t)hdr.total_frags + 7) / 8;
+    if (hdr.total_frags == 0 || hdr.total_frags > ESPNOW_MAX_FRAGMENTS ||
+        (size_t)len < sizeof(hdr) + bitmap_len) {
+        return;
+    }
+
+    lock();
+    const bool match = g_ctx.rel_tx.active &&
+                       g_ctx.rel_tx.msg_id == hdr.msg_id &&
+                       g_ctx.rel_tx.total_frags == hdr.total_frags &&
+                       mac_equal(g_ctx.rel_tx.peer, src_mac);
+    if (match) {
+        const uint8_t* bitmap = data + sizeof(hdr);
+        for (size_t i = 0; i < bitmap_len; ++i) {
+            g_ctx.rel_tx.acked[i] |= bitmap[i];
+        }
+        if (hdr.flags & ESPNOW_NACK_FLAG_COMPLETE) {
+            g_ctx.rel_tx.complete = true;
+        }
+    }
+    unlock();
+
+    if (match) {
+        xSemaphoreGive(g_ctx.rel_nack);
+    }
+}
+
+// st: Statistikblock des Absenders, von apply_rx_meta für diesen Frame aufgelöst
+static esp_err_t on_data_recv(const uint8_t src_mac[6], const uint8_t* data, const int len,
+                              espnow_stats_block_t* st) {
+    if (!src_mac || !data || len < 1) return ESP_OK;
+
+    switch (data[0]) {
+        case ESPNOW_FRAME_SINGLE:
+            on_single_recv(src_mac, data, len, st);
+            break;
+        case ESPNOW_FRAME_FRAG:
+            on_fragment_recv(src_mac, data, len, st);
+            break;
+        case ESPNOW_FRAME_NACK:
+            on_nack_recv(src_mac, data, len);
+            break;
+        case ESPNOW_FRAME_POLL:
+            on_poll_recv(src_mac, data, len);
+            break;
+        default:
+            ESP_LOGW(TAG, "Unknown frame type %u", data[0]);
+            STAT_INC(st, frags_dropped);
+            break;
     }
-    if (full) free(full);
     return ESP_OK;
 }
 
+// Empfangsmetadaten eines Frames in Peer-Eintrag und Statistik übernehmen.
+// @return Statistikblock des Absenders für die übrigen Zähler dieses Frames
+static espnow_stats_block_t* apply_rx_meta(const uint8_t src_mac[6], const uint32_t rx_ms, const bool has_rssi, const int8_t rssi) {
+    peer_lock();
+    espnow_peer_slot_t* peer = peer_find(src_mac);
+    espnow_stats_block_t* st = stats_of(peer);
+    if (peer) {
+        peer->info.last_seen_ms = rx_ms;
+        if (has_rssi) peer->info.rssi = rssi;
+    }
+    STAT_INC(st, rx_frames);
+    if (has_rssi) {
+        // RSSI-EWMA (Gewicht 1/8) in 1/16 dBm; Schreiber halten peer_lock
+        const int sample = (int)rssi * 16;
+        const int avg = atomic_load_explicit(&st->rssi_q4, memory_order_relaxed);
+        atomic_store_explicit(&st->rssi_q4, avg == 0 ? sample : avg + (sample - avg) / 8, memory_order_relaxed);
+    }
+    peer_unlock();
+    return st;
+}
+
+// Sendestatus eines Frames in Statistik und Zustellquote übernehmen
+static void apply_tx_status(const uint8_t dst_mac[6], const bool ok, const int64_t done_us) {
+    // Zustellquote als EWMA (Gewicht 1/8); Broadcasts werden nie quittiert und zählen nicht
+    peer_lock();
+    g_ctx.tx_completed++;
+    send_marks_complete(done_us);
+    espnow_peer_slot_t* peer = mac_equal(dst_mac, s_bcast_mac) ? NULL : peer_find(dst_mac);
+    espnow_stats_block_t* st = stats_of(peer);
+    STAT_INC(st, tx_frames);
+    if (!ok) STAT_INC(st, tx_failed);
+    if (peer) {
+        const int32_t target = ok ? UINT16_MAX : 0;
+        peer->tx_quality = (uint16_t)(peer->tx_quality + (target - (int32_t)peer->tx_quality) / 8);
+        peer->info.link_quality = (uint8_t)(((uint32_t)peer->tx_quality * 100 + UINT16_MAX / 2) / UINT16_MAX);
+    }
+    peer_unlock();
+}
+
+// Producer-Seite: läuft im Wi-Fi-Task, kopiert nur den Rohframe samt Metadaten und weckt die Worker-Task
+static void rx_ring_push(const esp_now_recv_info_t* recv_info, const uint8_t* data, const int len) {
+    const unsigned head = atomic_load_explicit(&s_rx_ring.head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&s_rx_ring.tail, memory_order_acquire);
+    if (head - tail >= ESPNOW_RX_RING_DEPTH) {
+        atomic_fetch_add_explicit(&s_rx_ring.drops, 1, memory_order_relaxed);
+        return;
+    }
+    espnow_rx_frame_t* f = &s_rx_ring.slots[head & (ESPNOW_RX_RING_DEPTH - 1)];
+    memcpy(f->src_mac, recv_info->src_addr, 6);
+    f->len = (uint16_t)len;
+    f->rx_ms = now_ms();
+    f->has_rssi = recv_info->rx_ctrl != NULL;
+    f->rssi = f->has_rssi ? (int8_t)recv_info->rx_ctrl->rssi : 0;
+    memcpy(f->data, data, (size_t)len);
+    atomic_store_explicit(&s_rx_ring.head, head + 1, memory_order_release);
+    xTaskNotifyGive(g_ctx.worker);
+}
+
+// Producer-Seite des Statusrings, ebenfalls im Wi-Fi-Task
+static void tx_status_push(const uint8_t dst_mac[6], const bool ok, const int64_t done_us) {
+    const unsigned head = atomic_load_explicit(&s_tx_status_ring.head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&s_tx_status_ring.tail, memory_order_acquire);
+    if (head - tail >= ESPNOW_TX_STATUS_RING_DEPTH) {
+        atomic_fetch_add_explicit(&s_tx_status_ring.drops, 1, memory_order_relaxed);
+        return;
+    }
+    espnow_tx_result_t* e = &s_tx_status_ring.slots[head & (ESPNOW_TX_STATUS_RING_DEPTH - 1)];
+    memcpy(e->dst_mac, dst_mac, 6);
+    e->ok = ok;
+    e->done_us = done_us;
+    atomic_store_explicit(&s_tx_status_ring.head, head + 1, memory_order_release);
+    xTaskNotifyGive(g_ctx.worker);
+}
+
+// Consumer-Seite: Reassembly, Anwendungs-Callback und Peer-Buchhaltung außerhalb des Wi-Fi-Tasks
+static void rx_worker_task(void* arg) {
+    (void)arg;
+    unsigned reported_drops = 0;
+    unsigned reported_status_drops = 0;
+
+    while (!g_ctx.worker_stop) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        unsigned tail = atomic_load_explicit(&s_tx_status_ring.tail, memory_order_relaxed);
+        while (tail != atomic_load_explicit(&s_tx_status_ring.head, memory_order_acquire)) {
+            const espnow_tx_result_t* e = &s_tx_status_ring.slots[tail & (ESPNOW_TX_STATUS_RING_DEPTH - 1)];
+            apply_tx_status(e->dst_mac, e->ok, e->done_us);
+            atomic_store_explicit(&s_tx_status_ring.tail, ++tail, memory_order_release);
+        }
+        const unsigned status_drops = atomic_load_explicit(&s_tx_status_ring.drops, memory_order_relaxed);
+        if (status_drops != reported_status_drops) {
+            // Verworfene Status fehlen in der Statistik, zählen aber als gemeldet: sonst endete
+            // jede weitere Latenzmessung einen Frame zu spät
+            peer_lock();
+            g_ctx.tx_completed += status_drops - reported_status_drops;
+            send_marks_complete(esp_timer_get_time());
+            peer_unlock();
+            ESP_LOGW(TAG, "TX status ring full, %u send results not counted", status_drops);
+            reported_status_drops = status_drops;
+        }
+
+        tail = atomic_load_explicit(&s_rx_ring.tail, memory_order_relaxed);
+        while (tail != atomic_load_explicit(&s_rx_ring.head, memory_order_acquire)) {
+            const espnow_rx_frame_t* f = &s_rx_ring.slots[tail & (ESPNOW_RX_RING_DEPTH - 1)];
+            espnow_stats_block_t* st = apply_rx_meta(f->src_mac, f->rx_ms, f->has_rssi, f->rssi);
+            (void)on_data_recv(f->src_mac, f->data, f->len, st);
+            atomic_store_explicit(&s_rx_ring.tail, ++tail, memory_order_release);
+        }
+
+        const unsigned drops = atomic_load_explicit(&s_rx_ring.drops, memory_order_relaxed);
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "RX ring full, %u frames dropped so far", drops);
+            reported_drops = drops;
+        }
+    }
+
+    xSemaphoreGive(g_ctx.worker_done);
+    vTaskDelete(NULL);
+}
+
+// Wi-Fi-Task. Mit ESPNOW_DISPATCH_TASK ohne Locks: Peer-Daten und Statistik pflegt die Worker-Task.
+// Inline wird direkt unter peer_lock gebucht; das ist Teil des Inline-Vertrags (kurze Sperren).
 static void espnow_recv_cb(const esp_now_recv_info_t* recv_info, const uint8_t* data, int len) {
-    (void)on_data_recv(recv_info, data, len);
+    if (!recv_info || !data || len < 1 || len > ESP_NOW_MAX_DATA_LEN) return;
+
+    if (g_ctx.dispatch == ESPNOW_DISPATCH_TASK) {
+        rx_ring_push(recv_info, data, len);
+    } else {
+        const bool has_rssi = recv_info->rx_ctrl != NULL;
+        espnow_stats_block_t* st = apply_rx_meta(recv_info->src_addr, now_ms(), has_rssi,
+                                                 has_rssi ? (int8_t)recv_info->rx_ctrl->rssi : 0);
+        (void)on_data_recv(recv_info->src_addr, data, len, st);
+    }
 }
 
 static void espnow_send_cb(const wifi_tx_info_t* tx_info, esp_now_send_status_t status) {
-    (void)tx_info; // Optional: Falls Sie nichts daraus lesen wollen
     ESP_LOGV(TAG, "Send status=%d", (int)status);
+
+    if (tx_info && tx_info->des_addr) {
+        const bool ok = status == ESP_NOW_SEND_SUCCESS;
+        if (g_ctx.dispatch == ESPNOW_DISPATCH_TASK) {
+            tx_status_push(tx_info->des_addr, ok, esp_timer_get_time());
+        } else {
+            apply_tx_status(tx_info->des_addr, ok, esp_timer_get_time());
+        }
+    }
+
+    // Frame hat den Treiber verlassen: Fensterplatz freigeben (überzählige Gives scheitern am Maximum)
+    if (g_ctx.tx_credits) xSemaphoreGive(g_ctx.tx_credits);
 }
 
 esp_err_t espnow_set_pmk(const uint8_t key[ESPNOW_KEY_LEN]) {
@@ -247,27 +1079,130 @@ esp_err_t espnow_add_peer(const uint8_t peer_mac[6], const uint8_t* lmk, const b
         if (!lmk) return ESP_ERR_INVALID_ARG;
         memcpy(peer.lmk, lmk, ESPNOW_KEY_LEN);
     }
+
+    // Broadcast ist kein echter Gegenüber und wird nicht im Register geführt
+    const bool unicast = !mac_equal(peer_mac, s_bcast_mac);
+
+    peer_lock();
+    espnow_peer_slot_t* slot = unicast ? peer_find(peer_mac) : NULL;
+    if (unicast && !slot && g_ctx.peer_count >= ESPNOW_MAX_PEERS) {
+        peer_evict(peer_mac, false);
+    }
+
     // idf: esp_now_add_peer ist idempotent für existierenden Peer -> vorher entfernen zur Sicherheit
     esp_now_del_peer(peer.peer_addr);
-    return esp_now_add_peer(&peer);
+    esp_err_t err = esp_now_add_peer(&peer);
+    // Treiberlimit (gesamt oder verschlüsselt) erreicht: Platz schaffen und einmal wiederholen
+    if (err == ESP_ERR_ESPNOW_FULL && unicast && peer_evict(peer_mac, encrypt)) {
+        err = esp_now_add_peer(&peer);
+    }
+
+    if (unicast) {
+        if (err == ESP_OK) {
+            const bool fresh = !slot;
+            if (fresh) slot = peer_insert(peer_mac);
+            slot->info.encrypt = encrypt;
+            slot->info.last_seen_ms = now_ms();
+            if (fresh) {
+                // Optimistischer Startwert, bis die ersten Sende-Callbacks eintreffen
+                slot->tx_quality = UINT16_MAX;
+                slot->info.link_quality = 100;
+            }
+        } else if (slot) {
+            // Treibereintrag ist bereits gelöscht: Register konsistent halten
+            peer_erase(slot);
+        }
+    }
+    peer_unlock();
+    return err;
 }
 
 esp_err_t espnow_remove_peer(const uint8_t peer_mac[6]) {
     if (!g_ctx.initialized || !peer_mac) return ESP_ERR_INVALID_STATE;
-    return esp_now_del_peer(peer_mac);
+    peer_lock();
+    espnow_peer_slot_t* slot = peer_find(peer_mac);
+    if (slot) peer_erase(slot);
+    const esp_err_t err = esp_now_del_peer(peer_mac);
+    peer_unlock();
+    return err;
+}
+
+bool espnow_peer_known(const uint8_t peer_mac[6]) {
+    if (!peer_mac) return false;
+    peer_lock();
+    const bool known = peer_find(peer_mac) != NULL;
+    peer_unlock();
+    return known;
 }
 
+esp_err_t espnow_get_peer(const uint8_t peer_mac[6], espnow_peer_info_t* out) {
+    if (!peer_mac || !out) return ESP_ERR_INVALID_ARG;
+    peer_lock();
+    const espnow_peer_slot_t* slot = peer_find(peer_mac);
+    if (slot) *out = slot->info;
+    peer_unlock();
+    return slot ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+size_t espnow_get_peers(espnow_peer_info_t* out, const size_t max) {
+    if (!out) return 0;
+    size_t n = 0;
+    peer_lock();
+    for (size_t i = 0; i < ESPNOW_PEER_TABLE_SIZE && n < max; ++i) {
+        if (g_ctx.peers[i].used) out[n++] = g_ctx.peers[i].info;
+    }
+    peer_unlock();
+    return n;
+}
+
+static void tx_worker_task(void* arg);
+
 esp_err_t espnow_init(const wifi_interface_t ifx, const espnow_recv_cb_t recv_cb, void* user_ctx) {
-    if (g_ctx.initialized) return ESP_OK;
+    espnow_config_t cfg = ESPNOW_CONFIG_DEFAULT();
+    cfg.ifx = ifx;
+    cfg.recv_cb = recv_cb;
+    cfg.user_ctx = user_ctx;
+    return espnow_init_with_config(&cfg);
+}
 
+// Hält Worker und TX-Task an und gibt alle Handles frei; für espnow_deinit() und den
+// Abbruch von espnow_init_with_config(). Nur gesetzte Handles werden angefasst.
+static void release_resources(void) {
+    if (g_ctx.worker) {
+        g_ctx.worker_stop = true;
+        xTaskNotifyGive(g_ctx.worker);
+        xSemaphoreTake(g_ctx.worker_done, portMAX_DELAY);
+        g_ctx.worker = NULL;
+    }
+    if (g_ctx.worker_done) {
+        vSemaphoreDelete(g_ctx.worker_done);
+        g_ctx.worker_done = NULL;
+    }
+    if (g_ctx.tx_task) {
+        // Leerer Auftrag weckt die Task; offene Aufträge werden verworfen
+        const espnow_tx_job_t wake = {0};
+        g_ctx.tx_stop = true;
+        xQueueSend(g_ctx.tx_queue, &wake, portMAX_DELAY);
+        xSemaphoreTake(g_ctx.tx_task_done, portMAX_DELAY);
+        g_ctx.tx_task = NULL;
+    }
+    if (g_ctx.tx_task_done) vSemaphoreDelete(g_ctx.tx_task_done);
+    if (g_ctx.tx_queue) vQueueDelete(g_ctx.tx_queue);
+    if (g_ctx.tx_credits) vSemaphoreDelete(g_ctx.tx_credits);
+    if (g_ctx.rel_lock) vSemaphoreDelete(g_ctx.rel_lock);
+    if (g_ctx.rel_nack) vSemaphoreDelete(g_ctx.rel_nack);
+    if (g_ctx.peer_lock) vSemaphoreDelete(g_ctx.peer_lock);
+    if (g_ctx.tx_lock) vSemaphoreDelete(g_ctx.tx_lock);
+    if (g_ctx.lock) vSemaphoreDelete(g_ctx.lock);
     memset(&g_ctx, 0, sizeof(g_ctx));
-    g_ctx.ifx = ifx;
-    g_ctx.recv_cb = recv_cb;
-    g_ctx.user_ctx = user_ctx;
-    g_ctx.lock = xSemaphoreCreateMutex();
-    if (!g_ctx.lock) return ESP_ERR_NO_MEM;
+}
+
+esp_err_t espnow_init_with_config(const espnow_config_t* cfg) {
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (g_ctx.initialized) return ESP_OK;
 
     // Wi-Fi muss bereits initialisiert und gestartet sein (STA/AP). Wir verändern das nicht.
+    // Geprüft wird vor jeder Allokation, damit ein Fehlschlag nichts zurücklässt.
     wifi_mode_t mode = WIFI_MODE_NULL;
     ESP_ERROR_CHECK_WITHOUT_ABORT(esp_wifi_get_mode(&mode));
     if (mode == WIFI_MODE_NULL) {
@@ -276,12 +1211,62 @@ esp_err_t espnow_init(const wifi_interface_t ifx, const espnow_recv_cb_t recv_cb
     }
 
     esp_err_t err = esp_now_init();
+    const bool now_owned = (err == ESP_OK); // bei EXIST gehört esp_now jemand anderem
     if (err == ESP_ERR_ESPNOW_EXIST) err = ESP_OK;
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "esp_now_init failed: %s", esp_err_to_name(err));
         return err;
     }
 
+    memset(&g_ctx, 0, sizeof(g_ctx));
+    g_ctx.ifx = cfg->ifx;
+    g_ctx.recv_cb = cfg->recv_cb;
+    g_ctx.user_ctx = cfg->user_ctx;
+    g_ctx.dispatch = cfg->dispatch;
+    g_ctx.reasm_timeout_ms = cfg->reasm_timeout_ms;
+    g_ctx.max_slots_per_peer = cfg->max_slots_per_peer;
+    // Zufälliger Start statt 1: Der Empfänger merkt sich abgeschlossene zuverlässige Nachrichten
+    // über (MAC, msg_id) und bestätigt Wiederholungen ohne Zustellung. Nach einem Neustart
+    // würden die ersten IDs sonst noch in seinem rel_done-Cache stehen.
+    g_ctx.next_msg_id = (uint16_t)esp_random();
+    g_ctx.lock = xSemaphoreCreateMutex();
+    g_ctx.tx_credits = xSemaphoreCreateCounting(ESPNOW_TX_WINDOW, ESPNOW_TX_WINDOW);
+    g_ctx.rel_lock = xSemaphoreCreateMutex();
+    g_ctx.rel_nack = xSemaphoreCreateBinary();
+    g_ctx.peer_lock = xSemaphoreCreateMutex();
+    g_ctx.tx_lock = xSemaphoreCreateMutex();
+    if (!g_ctx.lock || !g_ctx.tx_credits || !g_ctx.rel_lock || !g_ctx.rel_nack || !g_ctx.peer_lock ||
+        !g_ctx.tx_lock) {
+        goto fail;
+    }
+
+    g_ctx.tx_queue_depth = cfg->tx_queue_depth;
+    g_ctx.tx_queue = xQueueCreate(cfg->tx_queue_depth, sizeof(espnow_tx_job_t));
+    g_ctx.tx_task_done = xSemaphoreCreateBinary();
+    if (!g_ctx.tx_queue || !g_ctx.tx_task_done ||
+        xTaskCreate(tx_worker_task, "espnow_tx", 4096, NULL, cfg->tx_priority, &g_ctx.tx_task) != pdPASS) {
+        g_ctx.tx_task = NULL;
+        ESP_LOGE(TAG, "Could not start ESPNOW TX task");
+        goto fail;
+    }
+
+    if (g_ctx.dispatch == ESPNOW_DISPATCH_TASK) {
+        atomic_store(&s_rx_ring.head, 0);
+        atomic_store(&s_rx_ring.tail, 0);
+        atomic_store(&s_rx_ring.drops, 0);
+        atomic_store(&s_tx_status_ring.head, 0);
+        atomic_store(&s_tx_status_ring.tail, 0);
+        atomic_store(&s_tx_status_ring.drops, 0);
+        g_ctx.worker_done = xSemaphoreCreateBinary();
+        if (!g_ctx.worker_done ||
+            xTaskCreate(rx_worker_task, "espnow_rx", cfg->worker_stack_size, NULL,
+                        cfg->worker_priority, &g_ctx.worker) != pdPASS) {
+            g_ctx.worker = NULL;
+            ESP_LOGE(TAG, "Could not start ESPNOW RX worker");
+            goto fail;
+        }
+    }
+
     ESP_ERROR_CHECK_WITHOUT_ABORT(esp_now_register_recv_cb(espnow_recv_cb));
     ESP_ERROR_CHECK_WITHOUT_ABORT(esp_now_register_send_cb(espnow_send_cb));
 
@@ -289,8 +1274,15 @@ esp_err_t espnow_init(const wifi_interface_t ifx, const espnow_recv_cb_t recv_cb
     // Beispiel: uint8_t pmk[16] = { ... }; espnow_set_pmk(pmk);
 
     g_ctx.initialized = true;
-    ESP_LOGI(TAG, "ESPNOW initialized on ifx=%d", (int)ifx);
+    ESP_LOGI(TAG, "ESPNOW initialized on ifx=%d (dispatch=%s)", (int)cfg->ifx,
+             g_ctx.dispatch == ESPNOW_DISPATCH_TASK ? "task" : "inline");
     return ESP_OK;
+
+fail:
+    // Bereits gestartete Tasks anhalten und alles freigeben; initialized bleibt false
+    release_resources();
+    if (now_owned) esp_now_deinit();
+    return ESP_ERR_NO_MEM;
 }
 
 esp_err_t espnow_deinit(void) {
@@ -298,12 +1290,7 @@ esp_err_t espnow_deinit(void) {
     esp_now_unregister_recv_cb();
     esp_now_unregister_send_cb();
     esp_now_deinit();
-
-    if (g_ctx.lock) {
-        vSemaphoreDelete(g_ctx.lock);
-        g_ctx.lock = NULL;
-    }
-    memset(&g_ctx, 0, sizeof(g_ctx));
+    release_resources();
     return ESP_OK;
 }
 
@@ -315,42 +1302,274 @@ static uint16_t next_msg_id(void) {
     return id;
 }
 
+static esp_err_t check_message_len(const size_t len, uint16_t* total_frags) {
+    *total_frags = (len == 0) ? 1 : (uint16_t)((len + ESPNOW_FRAGMENT_PAYLOAD - 1) / ESPNOW_FRAGMENT_PAYLOAD);
+    if (*total_frags > ESPNOW_MAX_FRAGMENTS) {
+        ESP_LOGE(TAG, "Message too large: requires %u fragments (max %u)", *total_frags, (unsigned)ESPNOW_MAX_FRAGMENTS);
+        return ESP_ERR_NO_MEM;
+    }
+    if (len > ESPNOW_MAX_MESSAGE_SIZE) {
+        ESP_LOGE(TAG, "Message too large: %u bytes (max %u)", (unsigned)len, (unsigned)ESPNOW_MAX_MESSAGE_SIZE);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// Nachricht einmal kodieren und jeden fertigen Frame an alle Peers verteilen.
+// Ein Peer, bei dem ein Frame scheitert, bekommt den Rest der Nachricht nicht mehr.
+static esp_err_t send_message_multi(const uint8_t (*peers)[6], const size_t n_peers,
+                                    const uint8_t* p, const size_t len, const uint16_t total_frags,
+                                    const int64_t start_us, esp_err_t* status) {
+    for (size_t k = 0; k < n_peers; ++k) status[k] = ESP_OK;
+
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    const bool single = len <= ESPNOW_SINGLE_MAX_PAYLOAD;
+    // Fast Path: passt die Nachricht in einen Frame, entfallen Msg-ID, Lock und Reassembly
+    const uint16_t msg_id = single ? 0 : next_msg_id();
+    const uint16_t frames = single ? 1 : total_frags;
+
+    for (uint16_t i = 0; i < frames; ++i) {
+        size_t frame_len;
+        if (single) {
+            frame[0] = ESPNOW_FRAME_SINGLE;
+            if (len > 0) memcpy(frame + sizeof(espnow_single_hdr_t), p, len);
+            frame_len = sizeof(espnow_single_hdr_t) + len;
+        } else {
+            frame_len = build_fragment(frame, p, len, msg_id, i, total_frags, 0);
+        }
+
+        for (size_t k = 0; k < n_peers; ++k) {
+            if (status[k] != ESP_OK) continue;
+            uint32_t seq;
+            status[k] = send_frame_seq(peers[k], frame, frame_len, pdMS_TO_TICKS(ESPNOW_TX_CREDIT_TIMEOUT_MS), &seq);
+            if (status[k] != ESP_OK) {
+                ESP_LOGE(TAG, "esp_now_send to " MACSTR " failed at frame %u/%u: %s",
+                         MAC2STR(peers[k]), i + 1, frames, esp_err_to_name(status[k]));
+            } else if (i + 1 == frames) {
+                send_mark_add(peers[k], seq, start_us);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < n_peers; ++k) {
+        if (status[k] != ESP_OK) return n_peers == 1 ? status[k] : ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
 esp_err_t espnow_send(const uint8_t peer_mac[6], const void* data, const size_t len) {
     if (!g_ctx.initialized || !peer_mac || (!data && len > 0)) return ESP_ERR_INVALID_STATE;
 
-    const uint8_t* p = data;
-    const uint16_t total_frags = (len == 0) ? 1 : (uint16_t)((len + ESPNOW_FRAGMENT_PAYLOAD - 1) / ESPNOW_FRAGMENT_PAYLOAD);
-    if (total_frags > ESPNOW_MAX_FRAGMENTS) {
-        ESP_LOGE(TAG, "Message too large: requires %u fragments (max %u)", total_frags, (unsigned)ESPNOW_MAX_FRAGMENTS);
-        return ESP_ERR_NO_MEM;
+    uint16_t total_frags;
+    const esp_err_t len_err = check_message_len(len, &total_frags);
+    if (len_err != ESP_OK) return len_err;
+
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t status;
+    return send_message_multi((const uint8_t (*)[6])peer_mac, 1, data, len, total_frags, start_us, &status);
+}
+
+esp_err_t espnow_send_multi(const uint8_t peers[][6], const size_t n_peers, const void* data, const size_t len,
+                            esp_err_t* status_out) {
+    if (!g_ctx.initialized || !peers || (!data && len > 0)) return ESP_ERR_INVALID_STATE;
+    if (n_peers == 0 || n_peers > ESPNOW_MAX_FANOUT) return ESP_ERR_INVALID_ARG;
+
+    uint16_t total_frags;
+    const esp_err_t len_err = check_message_len(len, &total_frags);
+    if (len_err != ESP_OK) return len_err;
+
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t status[ESPNOW_MAX_FANOUT];
+    const esp_err_t err = send_message_multi(peers, n_peers, data, len, total_frags, start_us, status);
+    if (status_out) memcpy(status_out, status, n_peers * sizeof(esp_err_t));
+    return err;
+}
+
+// Arbeitet die TX-Warteschlange ab; das Sendefenster taktet die Frames anhand der Sende-Callbacks
+static void tx_worker_task(void* arg) {
+    (void)arg;
+    espnow_tx_job_t job;
+
+    while (!g_ctx.tx_stop) {
+        if (xQueueReceive(g_ctx.tx_queue, &job, portMAX_DELAY) != pdTRUE) continue;
+        if (g_ctx.tx_stop) break;
+
+        esp_err_t status[ESPNOW_MAX_FANOUT];
+        uint16_t total_frags = 0;
+        const esp_err_t err = check_message_len(job.len, &total_frags);
+        if (err == ESP_OK) {
+            // Latenz ab dem Einreihen: enthält die Wartezeit in der TX-Warteschlange
+            send_message_multi((const uint8_t (*)[6])job.peers, job.n_peers,
+                               job.data ? job.data : job.inline_data, job.len, total_frags, job.enqueued_us, status);
+        }
+        if (job.done_cb) {
+            for (size_t k = 0; k < job.n_peers; ++k) {
+                job.done_cb(job.peers[k], err == ESP_OK ? status[k] : err, job.user_ctx);
+            }
+        }
     }
 
+    xSemaphoreGive(g_ctx.tx_task_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t espnow_send_async(const uint8_t peer_mac[6], const void* data, const size_t len,
+                            const espnow_send_done_cb_t done_cb, void* user_ctx) {
+    if (!peer_mac) return ESP_ERR_INVALID_STATE;
+    return espnow_send_multi_async((const uint8_t (*)[6])peer_mac, 1, data, len, done_cb, user_ctx);
+}
+
+esp_err_t espnow_send_multi_async(const uint8_t peers[][6], const size_t n_peers, const void* data, const size_t len,
+                                  const espnow_send_done_cb_t done_cb, void* user_ctx) {
+    if (!g_ctx.initialized || !peers || (!data && len > 0)) return ESP_ERR_INVALID_STATE;
+    if (n_peers == 0 || n_peers > ESPNOW_MAX_FANOUT) return ESP_ERR_INVALID_ARG;
+
+    uint16_t total_frags;
+    const esp_err_t len_err = check_message_len(len, &total_frags);
+    if (len_err != ESP_OK) return len_err;
+
+    espnow_tx_job_t job = {
+        .data = NULL,
+        .len = len,
+        .done_cb = done_cb,
+        .user_ctx = user_ctx,
+        .enqueued_us = esp_timer_get_time()
+    };
+    memcpy(job.peers, peers, n_peers * 6);
+    job.n_peers = (uint8_t)n_peers;
+    if (len <= sizeof(job.inline_data)) {
+        if (len > 0) memcpy(job.inline_data, data, len);
+    } else {
+        job.data = data;
+    }
+
+    if (xQueueSend(g_ctx.tx_queue, &job, 0) != pdTRUE) {
+        // Backpressure: Aufrufer entscheidet, ob verworfen, später wiederholt oder synchron gesendet wird
+        atomic_fetch_add_explicit(&g_ctx.tx_rejected, 1, memory_order_relaxed);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t espnow_get_tx_status(espnow_tx_status_t* out) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (!g_ctx.initialized) return ESP_ERR_INVALID_STATE;
+    out->queued = (uint32_t)uxQueueMessagesWaiting(g_ctx.tx_queue);
+    out->queue_depth = g_ctx.tx_queue_depth;
+    out->free_credits = (uint32_t)uxSemaphoreGetCount(g_ctx.tx_credits);
+    out->rejected = atomic_load_explicit(&g_ctx.tx_rejected, memory_order_relaxed);
+    out->driver_busy = atomic_load_explicit(&g_ctx.tx_driver_busy, memory_order_relaxed);
+    return ESP_OK;
+}
+
+static void stats_snapshot(const espnow_stats_block_t* st, espnow_link_stats_t* out) {
+    out->tx_frames = atomic_load_explicit(&st->tx_frames, memory_order_relaxed);
+    out->tx_failed = atomic_load_explicit(&st->tx_failed, memory_order_relaxed);
+    out->rx_frames = atomic_load_explicit(&st->rx_frames, memory_order_relaxed);
+    out->rx_messages = atomic_load_explicit(&st->rx_messages, memory_order_relaxed);
+    out->frags_dropped = atomic_load_explicit(&st->frags_dropped, memory_order_relaxed);
+    out->reasm_timeouts = atomic_load_explicit(&st->reasm_timeouts, memory_order_relaxed);
+    out->dup_frags = atomic_load_explicit(&st->dup_frags, memory_order_relaxed);
+    out->rssi_avg = (int8_t)(atomic_load_explicit(&st->rssi_q4, memory_order_relaxed) / 16);
+    for (size_t i = 0; i < ESPNOW_LATENCY_BUCKETS; ++i) {
+        out->send_latency_hist[i] = atomic_load_explicit(&st->send_latency_hist[i], memory_order_relaxed);
+        out->ack_latency_hist[i] = atomic_load_explicit(&st->ack_latency_hist[i], memory_order_relaxed);
+    }
+}
+
+esp_err_t espnow_get_stats(espnow_stats_t* out) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (!g_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    stats_snapshot(&g_ctx.other_stats, &out->other);
+    out->rx_ring_drops = atomic_load_explicit(&s_rx_ring.drops, memory_order_relaxed);
+    out->n_peers = 0;
+    peer_lock();
+    for (size_t i = 0; i < ESPNOW_PEER_TABLE_SIZE; ++i) {
+        const espnow_peer_slot_t* peer = &g_ctx.peers[i];
+        if (!peer->used) continue;
+        memcpy(out->peers[out->n_peers].mac, peer->info.mac, 6);
+        stats_snapshot(stats_of(peer), &out->peers[out->n_peers].link);
+        out->n_peers++;
+    }
+    peer_unlock();
+    return ESP_OK;
+}
+
+esp_err_t espnow_send_reliable(const uint8_t peer_mac[6], const void* data, const size_t len) {
+    if (!g_ctx.initialized || !peer_mac || (!data && len > 0)) return ESP_ERR_INVALID_STATE;
+    if (mac_equal(peer_mac, s_bcast_mac)) return ESP_ERR_INVALID_ARG;
+
+    const uint8_t* p = data;
+    uint16_t total_frags;
+    const esp_err_t len_err = check_message_len(len, &total_frags);
+    if (len_err != ESP_OK) return len_err;
+
+    const int64_t start_us = esp_timer_get_time();
+    xSemaphoreTake(g_ctx.rel_lock, portMAX_DELAY);
+
     const uint16_t msg_id = next_msg_id();
+    lock();
+    memset(&g_ctx.rel_tx, 0, sizeof(g_ctx.rel_tx));
+    memcpy(g_ctx.rel_tx.peer, peer_mac, 6);
+    g_ctx.rel_tx.msg_id = msg_id;
+    g_ctx.rel_tx.total_frags = total_frags;
+    g_ctx.rel_tx.active = true;
+    unlock();
+    xSemaphoreTake(g_ctx.rel_nack, 0); // veraltetes Signal einer früheren Übertragung verwerfen
+
+    esp_err_t result = ESP_ERR_TIMEOUT;
+    bool send_data = true;
+    uint8_t acked[sizeof(g_ctx.rel_tx.acked)] = {0};
 
-    for (uint16_t i = 0; i < total_frags; ++i) {
-        const size_t remaining = len - (size_t)i * ESPNOW_FRAGMENT_PAYLOAD;
-        uint16_t chunk = (uint16_t)((remaining >= ESPNOW_FRAGMENT_PAYLOAD) ? ESPNOW_FRAGMENT_PAYLOAD : remaining);
-        if (len == 0) chunk = 0;
-
-        uint8_t frame[sizeof(espnow_pkt_hdr_t) + ESPNOW_FRAGMENT_PAYLOAD];
-        espnow_pkt_hdr_t hdr = {
-            .msg_id = msg_id,
-            .seq_idx = i,
-            .total_frags = total_frags,
-            .payload_len = chunk
-        };
-        memcpy(frame, &hdr, sizeof(hdr));
-        if (chunk > 0) {
-            memcpy(frame + sizeof(hdr), p + (size_t)i * ESPNOW_FRAGMENT_PAYLOAD, chunk);
+    for (int round = 0; round < ESPNOW_RELIABLE_MAX_ROUNDS; ++round) {
+        if (send_data) {
+            // Nur fehlende Fragmente wiederholen; das letzte der Runde fordert den NACK an
+            int last = -1;
+            for (int i = total_frags - 1; i >= 0; --i) {
+                if (!((acked[i / 8] >> (i % 8)) & 1u)) { last = i; break; }
+            }
+            for (int i = 0; i <= last; ++i) {
+                if ((acked[i / 8] >> (i % 8)) & 1u) continue;
+                const uint8_t flags = ESPNOW_FRAG_FLAG_RELIABLE | (i == last ? ESPNOW_FRAG_FLAG_POLL : 0);
+                const esp_err_t err = send_fragment(peer_mac, p, len, msg_id, (uint16_t)i, total_frags, flags);
+                if (err != ESP_OK) {
+                    ESP_LOGW(TAG, "Reliable frag %d/%u not sent: %s", i + 1, total_frags, esp_err_to_name(err));
+                }
+            }
+        } else {
+            const espnow_poll_hdr_t poll = {
+                .type = ESPNOW_FRAME_POLL,
+                .flags = 0,
+                .msg_id = msg_id,
+                .total_frags = total_frags
+            };
+            (void)send_frame(peer_mac, (const uint8_t*)&poll, sizeof(poll), pdMS_TO_TICKS(ESPNOW_TX_CREDIT_TIMEOUT_MS));
         }
 
-        const esp_err_t err = esp_now_send(peer_mac, frame, sizeof(hdr) + chunk);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "esp_now_send failed at frag %u/%u: %s", i + 1, total_frags, esp_err_to_name(err));
-            return err;
+        // Ohne NACK nur nachfragen statt blind alles zu wiederholen
+        send_data = xSemaphoreTake(g_ctx.rel_nack, pdMS_TO_TICKS(ESPNOW_RELIABLE_ACK_TIMEOUT_MS)) == pdTRUE;
+
+        lock();
+        const bool complete = g_ctx.rel_tx.complete;
+        memcpy(acked, g_ctx.rel_tx.acked, sizeof(acked));
+        unlock();
+        if (complete) {
+            result = ESP_OK;
+            break;
         }
-        // Optional: kleine Verzögerung, um Congestion zu vermeiden
-        // vTaskDelay(pdMS_TO_TICKS(1));
     }
-    return ESP_OK;
-}
\ No newline at end of file
+
+    lock();
+    g_ctx.rel_tx.active = false;
+    unlock();
+    xSemaphoreGive(g_ctx.rel_lock);
+
+    if (result == ESP_OK) {
+        stats_record_ack_latency(peer_mac, start_us);
+    } else {
+        ESP_LOGW(TAG, "Reliable send msg=%u to " MACSTR " failed after %d rounds",
+                 msg_id, MAC2STR(peer_mac), ESPNOW_RELIABLE_MAX_ROUNDS);
+    }
+    return result;
+}
@@ -1,12 +1,41 @@
 #include "joystick.h"
 
+_Static_assert(JS_ADC_SAMPLE_HZ >= SOC_ADC_SAMPLE_FREQ_THRES_LOW, "ADC sample rate below hardware minimum");
+_Static_assert(JS_ADC_FRAME_CONV >= 2, "frame must hold at least one conversion per axis");
+
+// Kalibrierdatensatz im NVS
+typedef struct __attribute__((packed)) {
+    uint8_t version;   // JS_CALIB_VERSION
+    uint8_t reserved;
+    int16_t x_min, x_mid, x_max;
+    int16_t y_min, y_mid, y_max;
+} js_calib_record_t;
+
+static adc_continuous_handle_t s_adc = NULL;
+static uint8_t s_frame[JS_ADC_FRAME_BYTES];
+static js_sample_t s_last = {2048, 2048, 0, 0};
 
 // Hilfsfunktionen Joystick
 void joystick_init(void) {
+    const adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = JS_ADC_POOL_FRAMES * JS_ADC_FRAME_BYTES,
+        .conv_frame_size = JS_ADC_FRAME_BYTES,
+    };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_cfg, &s_adc));
 
-    adc1_config_width(JS_ADC_WIDTH);
-    adc1_config_channel_atten(JS_AXIS_X_CH, JS_ADC_ATTEN);
-    adc1_config_channel_atten(JS_AXIS_Y_CH, JS_ADC_ATTEN);
+    adc_digi_pattern_config_t pattern[2] = {
+        {.atten = JS_ADC_ATTEN, .channel = JS_AXIS_X_CH, .unit = ADC_UNIT_1, .bit_width = JS_ADC_WIDTH},
+        {.atten = JS_ADC_ATTEN, .channel = JS_AXIS_Y_CH, .unit = ADC_UNIT_1, .bit_width = JS_ADC_WIDTH},
+    };
+    const adc_continuous_config_t adc_cfg = {
+        .pattern_num = 2,
+        .adc_pattern = pattern,
+        .sample_freq_hz = JS_ADC_SAMPLE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(s_adc, &adc_cfg));
+    ESP_ERROR_CHECK(adc_continuous_start(s_adc));
 
     const gpio_config_t io = {
         .pin_bit_mask = 1ULL << JS_BTN_GPIO,
@@ -18,59 +47,87 @@ void joystick_init(void) {
     gpio_config(&io);
 }
 
-int read_raw_axis(adc1_channel_t ch) {
-    return adc1_get_raw(ch); // 0..4095
+// Mittelwert je Achse über einen Frame; fehlt eine Achse, bleibt ihr letzter Wert stehen
+static void decimate_frame(const uint8_t* frame, const uint32_t len, js_sample_t* out) {
+    uint32_t sum_x = 0, sum_y = 0;
+    uint16_t n_x = 0, n_y = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* d = (const adc_digi_output_data_t*)&frame[i];
+        if (d->type2.unit != ADC_UNIT_1) continue;
+        if (d->type2.channel == JS_AXIS_X_CH) {
+            sum_x += d->type2.data;
+            n_x++;
+        } else if (d->type2.channel == JS_AXIS_Y_CH) {
+            sum_y += d->type2.data;
+            n_y++;
+        }
+    }
+    if (n_x > 0) s_last.x = (int)((sum_x + n_x / 2) / n_x);
+    if (n_y > 0) s_last.y = (int)((sum_y + n_y / 2) / n_y);
+    s_last.n_x = n_x;
+    s_last.n_y = n_y;
+    *out = s_last;
 }
 
-int8_t normalize_axis_with_cal(int raw, const axis_calib_t* c) {
-    if (!c || !c->inited) return 0;
+esp_err_t joystick_read_sample(js_sample_t* out, const uint32_t timeout_ms) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (!s_adc) return ESP_ERR_INVALID_STATE;
 
-    // Schutz vor degenerate ranges
-    const int pos_span = (c->max > c->mid) ? (c->max - c->mid) : 1;
-    const int neg_span = (c->mid > c->min) ? (c->mid - c->min) : 1;
+    uint32_t len = 0;
+    esp_err_t err = adc_continuous_read(s_adc, s_frame, sizeof(s_frame), &len, timeout_ms);
+    if (err != ESP_OK) return err;
 
-    float pct;
-    if (raw >= c->mid) {
-        pct = ((float)(raw - c->mid) / (float)pos_span) * 100.0f;
-    } else {
-        pct = -((float)(c->mid - raw) / (float)neg_span) * 100.0f;
+    // Rückstau verwerfen: nur der neueste Frame zählt
+    uint32_t newer = 0;
+    while (adc_continuous_read(s_adc, s_frame, sizeof(s_frame), &newer, 0) == ESP_OK) {
+        len = newer;
     }
-
-    // Deadzone um 0
-    if (pct > -JS_DEADZONE_PC && pct < JS_DEADZONE_PC) pct = 0.0f;
-
-    if (pct > 100.0f) pct = 100.0f;
-    if (pct < -100.0f) pct = -100.0f;
-    return (int8_t)pct;
+    decimate_frame(s_frame, len, out);
+    return ESP_OK;
 }
 
-// Optional: leichte adaptive Erweiterung, falls neue Extrema erreicht werden
-void adapt_axis_calib(axis_calib_t* c, int raw) {
-    if (!c || !c->inited) return;
-    if (raw > c->max + JS_ADAPT_EPS) c->max = raw;
-    if (raw < c->min - JS_ADAPT_EPS) c->min = raw;
+static bool calib_plausible(const int min, const int mid, const int max) {
+    return min >= 0 && max <= JS_RAW_MAX && min <= mid && mid <= max && min < max;
 }
 
-// Kalibrierte Normalisierung: mappe Rohwert relativ zu kalibriertem Mittelpunkt auf -100..100
-int8_t normalize_axis_to_pct_cal(int raw, int mid) {
-    const int max = 4095;
-    // Asymmetrische Spannen links/rechts um Mittelwert
-    const float span_pos = (float)(max - mid);
-    const float span_neg = (float)(mid - 0);
-    float pct;
-
-    if (raw >= mid) {
-        pct = (span_pos > 1.0f) ? ((float)(raw - mid) / span_pos) * 100.0f : 0.0f;
-    } else {
-        pct = (span_neg > 1.0f) ? ((float)(raw - mid) / span_neg) * 100.0f : 0.0f;
+esp_err_t joystick_calib_load(axis_calib_t* x, axis_calib_t* y) {
+    if (!x || !y) return ESP_ERR_INVALID_ARG;
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(JS_CALIB_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) return err;
+    js_calib_record_t rec;
+    size_t len = sizeof(rec);
+    err = nvs_get_blob(nvs, JS_CALIB_NVS_KEY, &rec, &len);
+    nvs_close(nvs);
+    if (err != ESP_OK) return err;
+    if (len != sizeof(rec) || rec.version != JS_CALIB_VERSION) return ESP_ERR_INVALID_VERSION;
+    if (!calib_plausible(rec.x_min, rec.x_mid, rec.x_max) || !calib_plausible(rec.y_min, rec.y_mid, rec.y_max)) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // Deadzone um 0
-    if (pct > -JS_DEADZONE_PC && pct < JS_DEADZONE_PC) pct = 0.0f;
+    *x = (axis_calib_t){.min = rec.x_min, .mid = rec.x_mid, .max = rec.x_max};
+    *y = (axis_calib_t){.min = rec.y_min, .mid = rec.y_mid, .max = rec.y_max};
+    axis_calib_update(x);
+    axis_calib_update(y);
+    return ESP_OK;
+}
 
-    if (pct > 100.0f) pct = 100.0f;
-    if (pct < -100.0f) pct = -100.0f;
-    return (int8_t)pct;
+esp_err_t joystick_calib_save(const axis_calib_t* x, const axis_calib_t* y) {
+    if (!x || !y || !x->inited || !y->inited) return ESP_ERR_INVALID_ARG;
+
+    const js_calib_record_t rec = {
+        .version = JS_CALIB_VERSION,
+        .x_min = (int16_t)x->min, .x_mid = (int16_t)x->mid, .x_max = (int16_t)x->max,
+        .y_min = (int16_t)y->min, .y_mid = (int16_t)y->mid, .y_max = (int16_t)y->max,
+    };
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(JS_CALIB_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(nvs, JS_CALIB_NVS_KEY, &rec, sizeof(rec));
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    return err;
 }
 
 bool read_button_pressed(void) {
@@ -0,0 +1,118 @@
+#include "joystick_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "joystick_norm.h"
+
+// Glättungsgewicht eines einpoligen Tiefpasses mit Grenzfrequenz fc bei Periode Te:
+// alpha = r / (r + 1) mit r = 2π·fc·Te. Hier mit fc in mHz und Te in ms, also r·1e6.
+static uint32_t lp_alpha_q16(const uint32_t cutoff_mhz, const uint32_t period_ms) {
+    const uint64_t r = (uint64_t)6283 * cutoff_mhz * period_ms / 1000;
+    return (uint32_t)((r << 16) / (r + 1000000));
+}
+
+static int32_t lp_step(const int32_t prev, const int32_t x, const uint32_t alpha_q16) {
+    return prev + (int32_t)(((int64_t)(x - prev) * alpha_q16) / 65536);
+}
+
+static uint16_t median(const uint16_t* v, const uint8_t n) {
+    uint16_t s[JS_FILTER_MEDIAN_MAX];
+    memcpy(s, v, n * sizeof(s[0]));
+    // Einfügesortierung: bei höchstens fünf Werten billiger als alles andere
+    for (uint8_t i = 1; i < n; ++i) {
+        const uint16_t x = s[i];
+        uint8_t j = i;
+        while (j > 0 && s[j - 1] > x) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = x;
+    }
+    return s[n / 2];
+}
+
+void js_filter_init(js_axis_filter_t* f, const js_filter_config_t* cfg) {
+    if (!f) return;
+    const js_filter_config_t def = JS_FILTER_CONFIG_DEFAULT();
+    memset(f, 0, sizeof(*f));
+    js_filter_configure(f, cfg ? cfg : &def);
+}
+
+void js_filter_configure(js_axis_filter_t* f, const js_filter_config_t* cfg) {
+    if (!f || !cfg) return;
+    js_filter_config_t c = *cfg;
+    if (c.median_n < 1) c.median_n = 1;
+    if (c.median_n > JS_FILTER_MEDIAN_MAX) c.median_n = JS_FILTER_MEDIAN_MAX;
+    if ((c.median_n & 1) == 0) c.median_n--;
+    if (c.iir_alpha_pct < 1) c.iir_alpha_pct = 1;
+    if (c.iir_alpha_pct > 100) c.iir_alpha_pct = 100;
+    if (c.period_ms == 0) c.period_ms = JS_FILTER_PERIOD_MS;
+
+    if (c.median_n != f->cfg.median_n) {
+        f->hist_len = 0;
+        f->hist_pos = 0;
+    }
+    f->cfg = c;
+    f->iir_alpha_q16 = (uint32_t)c.iir_alpha_pct * 65536u / 100u;
+    f->d_alpha_q16 = lp_alpha_q16(c.euro_d_cutoff_mhz, c.period_ms);
+}
+
+int js_filter_raw(js_axis_filter_t* f, int raw) {
+    if (!f) return raw;
+    if (raw < 0) raw = 0;
+    if (raw > JS_RAW_MAX) raw = JS_RAW_MAX;
+
+    // Median über die letzten median_n Werte; bis das Fenster voll ist, über die vorhandenen
+    int x = raw;
+    if (f->cfg.median_n > 1) {
+        f->hist[f->hist_pos] = (uint16_t)raw;
+        f->hist_pos = (uint8_t)((f->hist_pos + 1) % f->cfg.median_n);
+        if (f->hist_len < f->cfg.median_n) f->hist_len++;
+        x = median(f->hist, f->hist_len);
+    }
+
+    const int32_t x_q8 = (int32_t)x << 8;
+    if (!f->primed) {
+        f->y_q8 = x_q8;
+        f->dx = 0;
+        f->primed = true;
+        return x;
+    }
+
+    const int32_t prev_q8 = f->y_q8;
+    switch (f->cfg.smooth) {
+        case JS_SMOOTH_IIR:
+            f->y_q8 = lp_step(f->y_q8, x_q8, f->iir_alpha_q16);
+            break;
+        case JS_SMOOTH_ONE_EURO: {
+            // Geschwindigkeit in Rohwert/s glätten, daraus die Grenzfrequenz ableiten
+            const int32_t dx = (int32_t)(((int64_t)(x_q8 - f->y_q8) * 1000 / f->cfg.period_ms) / 256);
+            f->dx = lp_step(f->dx, dx, f->d_alpha_q16);
+            const uint32_t cutoff = f->cfg.euro_min_cutoff_mhz +
+                                    (uint32_t)((uint64_t)f->cfg.euro_beta_uhz * (uint32_t)abs(f->dx) / 1000);
+            f->y_q8 = lp_step(f->y_q8, x_q8, lp_alpha_q16(cutoff, f->cfg.period_ms));
+            break;
+        }
+        case JS_SMOOTH_NONE:
+        default:
+            f->y_q8 = x_q8;
+            break;
+    }
+
+    // Anstiegsbegrenzung nach der Glättung: Sprünge, die Median und Tiefpass durchlassen,
+    // erreichen den Ausgang nur mit höchstens slew_max Rohwerten je Periode
+    if (f->cfg.slew_max > 0) {
+        const int32_t step_q8 = (int32_t)f->cfg.slew_max << 8;
+        if (f->y_q8 > prev_q8 + step_q8) f->y_q8 = prev_q8 + step_q8;
+        if (f->y_q8 < prev_q8 - step_q8) f->y_q8 = prev_q8 - step_q8;
+    }
+    return (int)((f->y_q8 + 128) >> 8);
+}
+
+int8_t js_filter_deadzone(js_axis_filter_t* f, const int8_t pct) {
+    if (!f || f->cfg.deadzone_hyst_pc == 0) return pct;
+    if (f->in_deadzone && abs(pct) < JS_DEADZONE_PC + f->cfg.deadzone_hyst_pc) return 0;
+    f->in_deadzone = (pct == 0);
+    return pct;
+}
@@ -0,0 +1,56 @@
+#include "joystick_norm.h"
+
+#include <stdlib.h>
+
+// Kehrwert 100/span als Q24, aufgerundet. Für |raw - mid| <= span < 4096 bleibt der
+// Fehler damit unter einer Stelle von (raw - mid) * 100 / span, das Abschneiden
+// liefert also dasselbe Ergebnis wie die exakte Division.
+static uint32_t pct_scale(const int span) {
+    const uint32_t s = (span > 0) ? (uint32_t)span : 1u;
+    return (uint32_t)(((100ull << JS_SCALE_SHIFT) + s - 1) / s);
+}
+
+static int8_t clamp_deadzone(int pct) {
+    if (abs(pct) < JS_DEADZONE_PC) pct = 0;
+    if (pct > 100) pct = 100;
+    if (pct < -100) pct = -100;
+    return (int8_t)pct;
+}
+
+void axis_calib_update(axis_calib_t* c) {
+    if (!c) return;
+    c->pos_scale = pct_scale(c->max - c->mid);
+    c->neg_scale = pct_scale(c->mid - c->min);
+    c->inited = true;
+}
+
+int8_t normalize_axis_with_cal(const int raw, const axis_calib_t* c) {
+    if (!c || !c->inited) return 0;
+
+    const int d = raw - c->mid;
+    const uint32_t scale = (d >= 0) ? c->pos_scale : c->neg_scale;
+    const int mag = (int)(((uint64_t)(uint32_t)abs(d) * scale) >> JS_SCALE_SHIFT);
+    return clamp_deadzone(d >= 0 ? mag : -mag);
+}
+
+// Optional: leichte adaptive Erweiterung, falls neue Extrema erreicht werden
+bool adapt_axis_calib(axis_calib_t* c, const int raw) {
+    if (!c || !c->inited) return false;
+    if (raw > c->max + JS_ADAPT_EPS) {
+        c->max = raw;
+    } else if (raw < c->min - JS_ADAPT_EPS) {
+        c->min = raw;
+    } else {
+        return false;
+    }
+    axis_calib_update(c);
+    return true;
+}
+
+// Kalibrierte Normalisierung: mappe Rohwert relativ zu kalibriertem Mittelpunkt auf -100..100
+int8_t normalize_axis_to_pct_cal(const int raw, const int mid) {
+    // Asymmetrische Spannen links/rechts um Mittelwert
+    const int span = (raw >= mid) ? (JS_RAW_MAX - mid) : mid;
+    const int pct = (span > 1) ? (raw - mid) * 100 / span : 0;
+    return clamp_deadzone(pct);
+}
@@ -2,22 +2,42 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
 
 #include "mqtt.h"
 #include "wlan.h"
 #include "sensors.h"
+#include "sensor_telemetry.h"
 #include "ntp.h"
 #include "espnow.h"
 #include "joystick.h"
 #include "motor.h"
 #include "driver/gpio.h"
 #include "led_config.h"
+#include "boot.h"
 
 
-#define DISABLE_HUMIDITY true
+#define ESPNOW_STATS_INTERVAL_MS 30000
+// true: alle Kanäle eines Fensters als eine Nachricht im InfluxDB Line Protocol unter
+// SENSOR_TELEMETRY_TOPIC; false: je Kanal ein JSON-Publish unter /sensor/<Kanal>
+#define SENSOR_TELEMETRY_BATCHED true
+#define SENSOR_TELEMETRY_TOPIC   "/telemetry/sensor"
+// Fenster je Nachricht; mehr als eins nur mit Zeitstempel (Fenster ohne NTP-Zeit gehen sofort raus)
+#ifndef SENSOR_TELEMETRY_WINDOWS
+#define SENSOR_TELEMETRY_WINDOWS 1
+#endif
+// Je Fenster eine Zeile pro Treiber; mit den Grenzen aus sensor_telemetry.h rund 2,2 KB je Fenster
+#define SENSOR_TELEMETRY_MAX_LEN (SENSOR_TELEMETRY_WINDOWS * SENSOR_MAX_DRIVERS * SENSOR_TELEMETRY_LINE_MAX_LEN)
+// Fenster, die bis zur ersten MQTT-Verbindung aufgehoben werden (je Fenster rund 300 Byte);
+// danach puffert die Outbox des MQTT-Clients auch über Verbindungsabbrüche hinweg. Nur
+// gebündelt und mit NTP-Zeit, sonst bekämen die Werte die spätere Ankunftszeit.
+#ifndef SENSOR_BACKLOG_WINDOWS
+#define SENSOR_BACKLOG_WINDOWS 6
+#endif
 
 
 
@@ -36,44 +56,200 @@ typedef enum : uint8_t {
 } disc_type_t;
 
 typedef struct __attribute__((packed)) {
-    uint8_t  type;  // DISC_HELLO oder DISC_ACK
-    uint8_t  ver;   // Protokollversion
-    uint16_t flags; // reserviert
+    uint8_t  type;    // DISC_HELLO oder DISC_ACK
+    uint8_t  ver;     // Protokollversion
+    uint8_t  channel; // aktueller Funkkanal des Absenders
+    uint8_t  flags;   // DISC_FLAG_*
     // Danach: Token als ASCII (ohne Nullterminator), direkt angehängt
     // Layout: [header][token bytes]
 } disc_hdr_t;
 
-#define DISC_PROTO_VER 1
-
-// Lokale Peer-Verwaltung (klein & simpel)
-typedef struct {
-    uint8_t mac[6];
-    bool used;
-} peer_entry_t;
+#define DISC_PROTO_VER 2
 
+// Absender ist mit einem AP verbunden; sein Kanal ist vorgegeben und die Gegenstelle folgt ihm
+#define DISC_FLAG_ANCHORED 0x01
 
-peer_entry_t s_known_peers[ESPNOW_MAX_PEERS] = {0};
+// Ohne Frame einer Gegenstelle seit DISC_LINK_TIMEOUT_MS sucht ein nicht verbundenes Gerät
+// alle Kanäle ab (je DISC_SCAN_DWELL_MS mit HELLO) und bleibt auf dem ersten, der antwortet
+#ifndef DISC_PERIOD_MS
+#define DISC_PERIOD_MS 2000
+#endif
+#ifndef DISC_LINK_TIMEOUT_MS
+#define DISC_LINK_TIMEOUT_MS (3 * DISC_PERIOD_MS)
+#endif
+#ifndef DISC_SCAN_DWELL_MS
+#define DISC_SCAN_DWELL_MS 200
+#endif
 
-// Hilfsfunktionen für Peerliste
 bool mac_equal6(const uint8_t a[6], const uint8_t b[6]) {
     return memcmp(a, b, 6) == 0;
 }
-bool peer_known(const uint8_t mac[6]) {
-    for (int i = 0; i < ESPNOW_MAX_PEERS; ++i) {
-        if (s_known_peers[i].used && mac_equal6(s_known_peers[i].mac, mac)) return true;
+
+// Zielliste für Steuer- und Testnachrichten: Broadcast + alle registrierten Peers
+static size_t collect_targets(uint8_t targets[ESPNOW_MAX_FANOUT][6]) {
+    espnow_peer_info_t peers[ESPNOW_MAX_PEERS];
+    const size_t n_peers = espnow_get_peers(peers, ESPNOW_MAX_PEERS);
+    size_t n = 0;
+    memcpy(targets[n++], ESPNOW_BCAST_MAC, 6);
+    for (size_t i = 0; i < n_peers && n < ESPNOW_MAX_FANOUT; ++i) {
+        memcpy(targets[n++], peers[i].mac, 6);
+    }
+    return n;
+}
+
+// Auto: stoppt die Motoren, wenn länger als JS_CMD_TIMEOUT_MS kein Steuerbefehl (auch kein Keepalive) kam
+static esp_timer_handle_t s_cmd_watchdog = NULL;
+
+static void on_cmd_timeout(void* arg)
+{
+    (void)arg;
+    ESP_LOGW("MOTOR", "Kein Steuerbefehl seit %d ms, Motoren gestoppt", JS_CMD_TIMEOUT_MS);
+    apply_motor_command_log(0, 0, false);
+}
+
+static void cmd_watchdog_feed(void)
+{
+    if (!s_cmd_watchdog) {
+        const esp_timer_create_args_t args = {
+            .callback = on_cmd_timeout,
+            .name = "cmd_watchdog"
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&args, &s_cmd_watchdog));
     }
-    return false;
+    esp_timer_stop(s_cmd_watchdog); // ESP_ERR_INVALID_STATE, falls nicht aktiv: unkritisch
+    esp_timer_start_once(s_cmd_watchdog, (uint64_t)JS_CMD_TIMEOUT_MS * 1000);
+}
+
+static uint32_t now_ms32(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
-bool peer_add_local(const uint8_t mac[6]) {
-    if (peer_known(mac)) return true;
-    for (int i = 0; i < ESPNOW_MAX_PEERS; ++i) {
-        if (!s_known_peers[i].used) {
-            memcpy(s_known_peers[i].mac, mac, 6);
-            s_known_peers[i].used = true;
-            return true;
+
+// Rolle festlegen; ab hier ist das Gerät fahrbereit (Motoren und ESPNOW laufen vor dem Joystick-Task)
+static void role_set(const role_t role)
+{
+    s_role = role;
+    boot_stage_done(BOOT_ROLE);
+    boot_stage_done(BOOT_DRIVABLE);
+}
+
+// Auto: zuletzt angenommene Sequenznummer je Controller. Broadcast- und Unicast-Kopie
+// desselben Befehls tragen dieselbe Nummer; nur die erste wird umgesetzt.
+typedef struct {
+    bool used;
+    uint8_t mac[6];
+    uint16_t seq;
+    uint32_t last_ms;
+} cmd_seq_entry_t;
+
+static cmd_seq_entry_t s_cmd_seq[CMD_SEQ_SENDERS];
+static uint32_t s_cmd_dropped = 0;
+
+// true, wenn seq neuer ist als der zuletzt angenommene Befehl dieses Senders.
+// Nur aus dem Empfangs-Callback aufrufen (ein Task, daher ohne Lock).
+static bool cmd_seq_accept(const uint8_t mac[6], const uint16_t seq)
+{
+    const uint32_t now = now_ms32();
+    cmd_seq_entry_t* e = NULL;
+    cmd_seq_entry_t* oldest = &s_cmd_seq[0];
+    for (size_t i = 0; i < CMD_SEQ_SENDERS; ++i) {
+        if (s_cmd_seq[i].used && mac_equal6(s_cmd_seq[i].mac, mac)) {
+            e = &s_cmd_seq[i];
+            break;
+        }
+        if (!s_cmd_seq[i].used || (oldest->used && s_cmd_seq[i].last_ms < oldest->last_ms)) {
+            oldest = &s_cmd_seq[i];
         }
     }
-    return false;
+    if (!e) {
+        e = oldest;
+        e->used = true;
+        memcpy(e->mac, mac, 6);
+    } else if ((int16_t)(seq - e->seq) <= 0 && (now - e->last_ms) < JS_CMD_TIMEOUT_MS) {
+        // Duplikat oder überholt; nach längerer Pause (z. B. Neustart des Controllers) wird neu synchronisiert
+        s_cmd_dropped++;
+        return false;
+    }
+    e->seq = seq;
+    e->last_ms = now;
+    return true;
+}
+
+// Controller: Histogramm der Round-Trip-Zeiten aus CMD_ECHO, Ausgabe alle RTT_REPORT_EVERY Echos
+#define RTT_BUCKETS      9
+#define RTT_REPORT_EVERY 100
+static const uint32_t s_rtt_bounds_ms[RTT_BUCKETS - 1] = {2, 5, 10, 20, 50, 100, 200, 500};
+static uint32_t s_rtt_hist[RTT_BUCKETS];
+static uint32_t s_rtt_count = 0;
+static uint32_t s_rtt_max_ms = 0;
+
+// Obergrenze des Buckets, in dem das q-Perzentil liegt (UINT32_MAX = über der letzten Grenze)
+static uint32_t rtt_percentile_bound(const uint32_t q_pct)
+{
+    const uint32_t target = (s_rtt_count * q_pct + 99) / 100;
+    uint32_t cum = 0;
+    for (size_t i = 0; i < RTT_BUCKETS - 1; ++i) {
+        cum += s_rtt_hist[i];
+        if (cum >= target) return s_rtt_bounds_ms[i];
+    }
+    return UINT32_MAX;
+}
+
+static void rtt_record(const uint32_t rtt_ms)
+{
+    size_t bucket = 0;
+    while (bucket < RTT_BUCKETS - 1 && rtt_ms >= s_rtt_bounds_ms[bucket]) bucket++;
+    s_rtt_hist[bucket]++;
+    s_rtt_count++;
+    if (rtt_ms > s_rtt_max_ms) s_rtt_max_ms = rtt_ms;
+
+    if (s_rtt_count < RTT_REPORT_EVERY) return;
+    ESP_LOGI("RTT", "n=%lu p50<%lu ms p99<%lu ms max=%lu ms | <2:%lu <5:%lu <10:%lu <20:%lu <50:%lu "
+             "<100:%lu <200:%lu <500:%lu >=500:%lu",
+             (unsigned long)s_rtt_count, (unsigned long)rtt_percentile_bound(50),
+             (unsigned long)rtt_percentile_bound(99), (unsigned long)s_rtt_max_ms,
+             (unsigned long)s_rtt_hist[0], (unsigned long)s_rtt_hist[1], (unsigned long)s_rtt_hist[2],
+             (unsigned long)s_rtt_hist[3], (unsigned long)s_rtt_hist[4], (unsigned long)s_rtt_hist[5],
+             (unsigned long)s_rtt_hist[6], (unsigned long)s_rtt_hist[7], (unsigned long)s_rtt_hist[8]);
+    memset(s_rtt_hist, 0, sizeof(s_rtt_hist));
+    s_rtt_count = 0;
+    s_rtt_max_ms = 0;
+}
+
+// Zeitpunkt des letzten Discovery- oder Steuerframes einer Gegenstelle (now_ms32)
+static atomic_uint s_disc_last_rx_ms = 0;
+
+// HELLO/ACK mit eigenem Kanal und Verbindungsstatus füllen
+static void disc_build(uint8_t buf[sizeof(disc_hdr_t) + sizeof(DISCOVERY_TOKEN) - 1], const disc_type_t type)
+{
+    const disc_hdr_t hdr = {
+        .type = type,
+        .ver = DISC_PROTO_VER,
+        .channel = wlan_get_channel(),
+        .flags = wlan_sta_associated() ? DISC_FLAG_ANCHORED : 0
+    };
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), DISCOVERY_TOKEN, sizeof(DISCOVERY_TOKEN) - 1);
+}
+
+// Gegenstelle gehört: Verbindung vermerken und ohne eigene AP-Verbindung auf ihren Kanal
+// wechseln. Empfangen wird ohnehin nur auf dem gemeinsamen Kanal; der Wechsel macht ihn
+// zum Kanal, auf den das Gerät nach Suchläufen und Verbindungsabbrüchen zurückkehrt.
+static void disc_link_seen(const disc_hdr_t* hdr)
+{
+    atomic_store(&s_disc_last_rx_ms, now_ms32());
+    if (wlan_sta_associated() || hdr->channel == 0) return;
+
+    static uint8_t s_locked_channel = 0;
+    if (hdr->channel == s_locked_channel) return;
+    const esp_err_t err = wlan_set_channel(hdr->channel);
+    if (err == ESP_OK) {
+        s_locked_channel = hdr->channel;
+        ESP_LOGI("ESPNOW", "Kanal %u übernommen (Gegenstelle %s)", (unsigned)hdr->channel,
+                 (hdr->flags & DISC_FLAG_ANCHORED) ? "mit AP" : "ohne AP");
+    } else {
+        ESP_LOGD("ESPNOW", "Kanal %u nicht übernommen: %s", (unsigned)hdr->channel, esp_err_to_name(err));
+    }
 }
 
 // ESPNOW-Empfangs-Callback: vollständige Nutzdaten
@@ -85,48 +261,45 @@ void on_espnow_recv(const uint8_t mac[6], const uint8_t* data, size_t len, void*
         const disc_hdr_t* hdr = (const disc_hdr_t*)data;
         const char* token_rx = (const char*)(data + sizeof(disc_hdr_t));
         size_t token_len = len - sizeof(disc_hdr_t);
+        const bool token_ok = token_len == strlen(DISCOVERY_TOKEN) &&
+                              memcmp(token_rx, DISCOVERY_TOKEN, token_len) == 0;
 
         // Discovery-HELLO behandeln
-        if (hdr->type == DISC_HELLO && hdr->ver == DISC_PROTO_VER) {
-            if (token_len == strlen(DISCOVERY_TOKEN) &&
-                memcmp(token_rx, DISCOVERY_TOKEN, token_len) == 0) {
+        if (hdr->type == DISC_HELLO && hdr->ver == DISC_PROTO_VER && token_ok) {
+            disc_link_seen(hdr);
 
-                // Peer ggf. hinzufügen
-                if (!peer_known(mac)) {
-                    ESP_LOGI("ESPNOW", "Discovery: neuer Peer %02X:%02X:%02X:%02X:%02X:%02X",
-                             mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
-                    if (espnow_add_peer(mac, NULL, false) == ESP_OK && peer_add_local(mac)) {
-                        ESP_LOGI("ESPNOW", "Peer hinzugefügt");
-                    } else {
-                        ESP_LOGW("ESPNOW", "Peer konnte nicht hinzugefügt werden (Liste voll?)");
-                    }
+            // Peer ggf. hinzufügen
+            if (!espnow_peer_known(mac)) {
+                ESP_LOGI("ESPNOW", "Discovery: neuer Peer %02X:%02X:%02X:%02X:%02X:%02X",
+                         mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+                const esp_err_t err = espnow_add_peer(mac, NULL, false);
+                if (err == ESP_OK) {
+                    ESP_LOGI("ESPNOW", "Peer hinzugefügt");
+                } else {
+                    ESP_LOGW("ESPNOW", "Peer konnte nicht hinzugefügt werden: %s", esp_err_to_name(err));
                 }
-
-                // Unicast ACK zurücksenden
-                uint8_t ack_buf[sizeof(disc_hdr_t) + sizeof(DISCOVERY_TOKEN) - 1];
-                disc_hdr_t ack = {.type = DISC_ACK, .ver = DISC_PROTO_VER, .flags = 0};
-                memcpy(ack_buf, &ack, sizeof(ack));
-                memcpy(ack_buf + sizeof(ack), DISCOVERY_TOKEN, sizeof(DISCOVERY_TOKEN) - 1);
-                espnow_send(mac, ack_buf, sizeof(ack_buf));
-                return;
             }
+
+            // Unicast ACK zurücksenden
+            uint8_t ack_buf[sizeof(disc_hdr_t) + sizeof(DISCOVERY_TOKEN) - 1];
+            disc_build(ack_buf, DISC_ACK);
+            espnow_send(mac, ack_buf, sizeof(ack_buf));
+            return;
         }
 
         // Discovery-ACK behandeln (nur Log/Bestätigung)
-        if (hdr->type == DISC_ACK && hdr->ver == DISC_PROTO_VER) {
-            if (token_len == strlen(DISCOVERY_TOKEN) &&
-                memcmp(token_rx, DISCOVERY_TOKEN, token_len) == 0) {
-                // Gegenstelle bestätigt – sicherstellen, dass sie als Peer erfasst ist
-                if (!peer_known(mac)) {
-                    if (espnow_add_peer(mac, NULL, false) == ESP_OK && peer_add_local(mac)) {
-                        ESP_LOGI("ESPNOW", "Peer via ACK hinzugefügt: %02X:%02X:%02X:%02X:%02X:%02X",
-                                 mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
-                    }
+        if (hdr->type == DISC_ACK && hdr->ver == DISC_PROTO_VER && token_ok) {
+            disc_link_seen(hdr);
+            // Gegenstelle bestätigt – sicherstellen, dass sie als Peer erfasst ist
+            if (!espnow_peer_known(mac)) {
+                if (espnow_add_peer(mac, NULL, false) == ESP_OK) {
+                    ESP_LOGI("ESPNOW", "Peer via ACK hinzugefügt: %02X:%02X:%02X:%02X:%02X:%02X",
+                             mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
                 }
-                ESP_LOGI("ESPNOW", "Discovery ACK von %02X:%02X:%02X:%02X:%02X:%02X",
-                         mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
-                return;
             }
+            ESP_LOGI("ESPNOW", "Discovery ACK von %02X:%02X:%02X:%02X:%02X:%02X (Kanal %u)",
+                     mac[0],mac[1],mac[2],mac[3],mac[4],mac[5], (unsigned)hdr->channel);
+            return;
         }
     }
 
@@ -136,20 +309,46 @@ void on_espnow_recv(const uint8_t mac[6], const uint8_t* data, size_t len, void*
         if (ch->magic[0] == CMD_MAGIC0 && ch->magic[1] == CMD_MAGIC1 &&
             ch->ver == CMD_PROTO_VER) {
 
+            if (ch->type == CMD_ECHO && len >= sizeof(cmd_echo_t)) {
+                if (s_role == ROLE_CONTROLLER) {
+                    cmd_echo_t echo;
+                    memcpy(&echo, data, sizeof(echo));
+                    rtt_record(now_ms32() - echo.t_ms);
+                }
+                return;
+            }
+
             if (ch->type == CMD_JOYSTICK && len >= sizeof(cmd_joystick_t)) {
-                const cmd_joystick_t* cj = (const cmd_joystick_t*)data;
+                cmd_joystick_t cmd;
+                memcpy(&cmd, data, sizeof(cmd));
+                const cmd_joystick_t* cj = &cmd;
+                if (!cmd_seq_accept(mac, cj->seq)) {
+                    ESP_LOGD("ESPNOW", "Cmd seq=%u verworfen (Duplikat/veraltet, gesamt %lu)",
+                             cj->seq, (unsigned long)s_cmd_dropped);
+                    return;
+                }
 
                 // Wenn wir keine Controller-Rolle haben, übernehme Auto-Rolle
                 if (s_role != ROLE_CONTROLLER) {
                     if (s_role != ROLE_CAR) {
-                        s_role = ROLE_CAR;
+                        role_set(ROLE_CAR);
                         ESP_LOGI("ROLE", "Rolle -> CAR (Empfänger) nach Eingang von Befehlen");
                     }
                 }
 
+                atomic_store(&s_disc_last_rx_ms, now_ms32());
                 const bool btn = (cj->buttons & 0x01) != 0;
                 apply_motor_command_log(cj->x_pct, cj->y_pct, btn);
-
+                cmd_watchdog_feed();
+
+                if (cj->flags & CMD_FLAG_ECHO_REQ) {
+                    const cmd_echo_t echo = {
+                        .hdr = {.magic = {CMD_MAGIC0, CMD_MAGIC1}, .type = CMD_ECHO, .ver = CMD_PROTO_VER},
+                        .seq = cj->seq,
+                        .t_ms = cj->t_ms
+                    };
+                    espnow_send_async(mac, &echo, sizeof(echo), NULL, NULL);
+                }
 
                 return;
             }
@@ -161,20 +360,38 @@ void on_espnow_recv(const uint8_t mac[6], const uint8_t* data, size_t len, void*
              (unsigned)len, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 }
 
-// Periodisches Discovery-Beaconing (Broadcast HELLO)
+// Periodisches Discovery-Beaconing (Broadcast HELLO). Ohne AP-Verbindung und ohne Gegenstelle
+// werden zusätzlich alle Kanäle abgesucht, z. B. wenn das andere Gerät einem AP-Kanal folgt.
 void espnow_discovery_task(void* arg)
 {
     (void)arg;
-    // HELLO-Payload vorbereiten
     uint8_t hello_buf[sizeof(disc_hdr_t) + sizeof(DISCOVERY_TOKEN) - 1];
-    disc_hdr_t hello = {.type = DISC_HELLO, .ver = DISC_PROTO_VER, .flags = 0};
-    memcpy(hello_buf, &hello, sizeof(hello));
-    memcpy(hello_buf + sizeof(hello), DISCOVERY_TOKEN, sizeof(DISCOVERY_TOKEN) - 1);
+    atomic_store(&s_disc_last_rx_ms, now_ms32());
 
     for (;;) {
-        // Broadcast-HELLO senden
+        // Broadcast-HELLO auf dem aktuellen Kanal
+        disc_build(hello_buf, DISC_HELLO);
         espnow_send(ESPNOW_BCAST_MAC, hello_buf, sizeof(hello_buf));
-        vTaskDelay(pdMS_TO_TICKS(2000));
+        vTaskDelay(pdMS_TO_TICKS(DISC_PERIOD_MS));
+
+        const uint32_t silent_ms = now_ms32() - atomic_load(&s_disc_last_rx_ms);
+        if (wlan_sta_associated() || silent_ms < DISC_LINK_TIMEOUT_MS) continue;
+
+        const uint8_t home = wlan_get_channel();
+        ESP_LOGI("ESPNOW", "Keine Gegenstelle seit %lu ms, suche Kanäle ab", (unsigned long)silent_ms);
+        bool found = false;
+        for (uint8_t ch = 1; ch <= WLAN_CHANNEL_MAX && !found; ++ch) {
+            if (ch == home) continue;
+            if (wlan_sta_associated() || esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE) != ESP_OK) break;
+            const uint32_t t0 = now_ms32();
+            disc_build(hello_buf, DISC_HELLO);
+            espnow_send(ESPNOW_BCAST_MAC, hello_buf, sizeof(hello_buf));
+            vTaskDelay(pdMS_TO_TICKS(DISC_SCAN_DWELL_MS));
+            // Antwort kam auf diesem Kanal: disc_link_seen() hat ihn bereits übernommen
+            found = (int32_t)(atomic_load(&s_disc_last_rx_ms) - t0) >= 0;
+        }
+        // Sonst zurück auf den bisherigen Kanal, damit sich zwei suchende Geräte dort treffen
+        if (!found && !wlan_sta_associated()) esp_wifi_set_channel(home, WIFI_SECOND_CHAN_NONE);
     }
 }
 
@@ -184,123 +401,192 @@ typedef struct __attribute__((packed)) {
     char     message[32]; // kurze Testnachricht
 } test_payload_t;
 
-// Joystick Sampling + Senden
-void joystick_sender_task(void* arg) {
-    (void)arg;
-    joystick_init();
+// Gesetzt, wenn ein Steuerbefehl einen Peer nicht erreicht hat: der nächste Abtastwert wird
+// dann auch ohne Änderung gesendet, statt bis zum Keepalive zu warten
+static atomic_bool s_cmd_resend = false;
+
+// Abschluss-Callback für asynchron gesendete Steuerbefehle
+static void on_cmd_sent(const uint8_t mac[6], esp_err_t result, void* user_ctx)
+{
+    (void)user_ctx;
+    if (result != ESP_OK && !mac_equal6(mac, ESPNOW_BCAST_MAC)) {
+        atomic_store(&s_cmd_resend, true);
+        ESP_LOGW("ESPNOW", "Cmd an %02X:%02X:%02X:%02X:%02X:%02X fehlgeschlagen: %s",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], esp_err_to_name(result));
+    }
+}
 
+// Filterzustand je Achse; Konfiguration zur Laufzeit per js_filter_configure() änderbar
+static js_axis_filter_t s_js_filter_x, s_js_filter_y;
+
+// Vollständige Kalibrierung: Mittelpunkt in Ruhe, danach min/max per Sweep (ca. 5,8 s)
+static void joystick_calibrate(axis_calib_t* cal_x, axis_calib_t* cal_y) {
     // Phase 1: Mittelpunkt-Kalibrierung
     uint32_t start_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
     uint32_t now_ms = start_ms;
     uint32_t cnt = 0;
     uint64_t sum_x = 0, sum_y = 0;
 
+    js_sample_t sample;
     while ((now_ms - start_ms) < JS_CALIB_MS) {
-        sum_x += (uint32_t)read_raw_axis(JS_AXIS_X_CH);
-        sum_y += (uint32_t)read_raw_axis(JS_AXIS_Y_CH);
-        cnt++;
-        vTaskDelay(pdMS_TO_TICKS(10));
+        if (joystick_read_sample(&sample, JS_SAMPLE_INTERVAL_MS * 4) == ESP_OK) {
+            sum_x += (uint32_t)sample.x;
+            sum_y += (uint32_t)sample.y;
+            cnt++;
+        }
         now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
     }
-    axis_calib_t cal_x = {0}, cal_y = {0};
-    cal_x.mid = (cnt > 0) ? (int)(sum_x / cnt) : 2048;
-    cal_y.mid = (cnt > 0) ? (int)(sum_y / cnt) : 2048;
+    cal_x->mid = (cnt > 0) ? (int)(sum_x / cnt) : 2048;
+    cal_y->mid = (cnt > 0) ? (int)(sum_y / cnt) : 2048;
 
     // Phase 2: Sweep für min/max (bitte in der Zeit einmal zu allen Extremen bewegen)
     start_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
     now_ms = start_ms;
-    cal_x.min = cal_x.max = cal_x.mid;
-    cal_y.min = cal_y.max = cal_y.mid;
+    cal_x->min = cal_x->max = cal_x->mid;
+    cal_y->min = cal_y->max = cal_y->mid;
 
     led_calib_init();
     led_calib_toggle();
 
     while ((now_ms - start_ms) < JS_CALIB_SWEEP_MS) {
-        const int rx = read_raw_axis(JS_AXIS_X_CH);
-        const int ry = read_raw_axis(JS_AXIS_Y_CH);
-
-        if (rx < cal_x.min) cal_x.min = rx;
-        if (rx > cal_x.max) cal_x.max = rx;
-        if (ry < cal_y.min) cal_y.min = ry;
-        if (ry > cal_y.max) cal_y.max = ry;
-
-        vTaskDelay(pdMS_TO_TICKS(10));
+        if (joystick_read_sample(&sample, JS_SAMPLE_INTERVAL_MS * 4) == ESP_OK) {
+            if (sample.x < cal_x->min) cal_x->min = sample.x;
+            if (sample.x > cal_x->max) cal_x->max = sample.x;
+            if (sample.y < cal_y->min) cal_y->min = sample.y;
+            if (sample.y > cal_y->max) cal_y->max = sample.y;
+        }
         now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
     }
     led_calib_toggle();
 
     // Fallbacks, falls keine Bewegung stattfand
-    if (cal_x.min == cal_x.max) { cal_x.min = cal_x.mid - 100; cal_x.max = cal_x.mid + 100; }
-    if (cal_y.min == cal_y.max) { cal_y.min = cal_y.mid - 100; cal_y.max = cal_y.mid + 100; }
-    cal_x.inited = true;
-    cal_y.inited = true;
+    if (cal_x->min == cal_x->max) { cal_x->min = cal_x->mid - 100; cal_x->max = cal_x->mid + 100; }
+    if (cal_y->min == cal_y->max) { cal_y->min = cal_y->mid - 100; cal_y->max = cal_y->mid + 100; }
+    axis_calib_update(cal_x);
+    axis_calib_update(cal_y);
+}
+
+// Joystick Sampling + Senden
+void joystick_sender_task(void* arg) {
+    (void)arg;
+    joystick_init();
+
+    js_filter_config_t filter_cfg = JS_FILTER_CONFIG_DEFAULT();
+    filter_cfg.period_ms = JS_SAMPLE_INTERVAL_MS;
+    js_filter_init(&s_js_filter_x, &filter_cfg);
+    js_filter_init(&s_js_filter_y, &filter_cfg);
+
+    // Kalibrierung aus dem NVS; fehlt sie oder ist beim Start die Taste gedrückt, neu kalibrieren
+    axis_calib_t cal_x = {0}, cal_y = {0};
+    bool calib_dirty = false;
+    uint32_t calib_changed_ms = 0;
+    js_sample_t sample;
+    const esp_err_t calib_err = read_button_pressed() ? ESP_ERR_INVALID_STATE : joystick_calib_load(&cal_x, &cal_y);
+    if (calib_err == ESP_OK) {
+        ESP_LOGI("JOYSTICK", "Kalibrierung aus NVS geladen");
+    } else {
+        ESP_LOGI("JOYSTICK", "Kalibriere neu (%s)", esp_err_to_name(calib_err));
+        joystick_calibrate(&cal_x, &cal_y);
+        calib_dirty = true;
+    }
 
     ESP_LOGI("JOYSTICK", "Cal X: min=%d mid=%d max=%d | Cal Y: min=%d mid=%d max=%d",
              cal_x.min, cal_x.mid, cal_x.max, cal_y.min, cal_y.mid, cal_y.max);
 
     int8_t last_x = 0, last_y = 0;
     bool last_btn = false;
+    int8_t sent_x = 0, sent_y = 0;
+    bool sent_btn = false;
+    uint32_t last_send_ms = 0;
+    uint16_t cmd_seq = 0;
     uint32_t t0 = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
-    bool activity_detected = false;
 
     for (;;) {
-        vTaskDelay(pdMS_TO_TICKS(JS_SAMPLE_INTERVAL_MS));
-
-        const int raw_x = read_raw_axis(JS_AXIS_X_CH);
-        const int raw_y = read_raw_axis(JS_AXIS_Y_CH);
+        // Takt kommt vom ADC: ein dezimierter DMA-Frame je JS_SAMPLE_INTERVAL_MS
+        const esp_err_t adc_err = joystick_read_sample(&sample, JS_SAMPLE_INTERVAL_MS * 4);
+        if (adc_err != ESP_OK) {
+            ESP_LOGW("JOYSTICK", "Kein ADC-Frame: %s", esp_err_to_name(adc_err));
+            continue;
+        }
+        const int raw_x = js_filter_raw(&s_js_filter_x, sample.x);
+        const int raw_y = js_filter_raw(&s_js_filter_y, sample.y);
         const bool btn = read_button_pressed();
 
-        // Adaptiv Extrema leicht erweitern (optional)
-        adapt_axis_calib(&cal_x, raw_x);
-        adapt_axis_calib(&cal_y, raw_y);
+        // Adaptiv Extrema leicht erweitern; gespeichert wird erst, wenn sie eine Weile stabil sind
+        const bool widened_x = adapt_axis_calib(&cal_x, raw_x);
+        const bool widened_y = adapt_axis_calib(&cal_y, raw_y);
+        if (widened_x || widened_y) {
+            calib_dirty = true;
+            calib_changed_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+        }
 
-        int8_t x_pct = normalize_axis_with_cal(raw_x, &cal_x);
-        int8_t y_pct = normalize_axis_with_cal(raw_y, &cal_y);
+        int8_t x_pct = js_filter_deadzone(&s_js_filter_x, normalize_axis_with_cal(raw_x, &cal_x));
+        int8_t y_pct = js_filter_deadzone(&s_js_filter_y, normalize_axis_with_cal(raw_y, &cal_y));
 
         // Hinweis: Achsen bei Bedarf invertieren
         // x_pct = -x_pct; // falls rechts/links vertauscht
         // y_pct = -y_pct; // falls vor/zurück vertauscht
 
-        // Aktivitätserkennung in der Anlaufphase
+        // Aktivitätserkennung in der Anlaufphase: Bewegung entscheidet sofort für CONTROLLER,
+        // CAR erst nach Ablauf von ROLE_DECISION_MS ohne Bewegung
         uint32_t now_ms2 = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
         if (s_role == ROLE_UNKNOWN && (now_ms2 - t0) <= ROLE_DECISION_MS) {
             if (abs(x_pct - last_x) >= JS_ACTIVITY_THRESHOLD ||
                 abs(y_pct - last_y) >= JS_ACTIVITY_THRESHOLD ||
                 btn != last_btn) {
-                activity_detected = true;
+                role_set(ROLE_CONTROLLER);
+                ESP_LOGI("ROLE", "Rolle entschieden: CONTROLLER (Sender) nach %lu ms",
+                         (unsigned long)(now_ms2 - t0));
             }
         } else if (s_role == ROLE_UNKNOWN) {
-            s_role = activity_detected ? ROLE_CONTROLLER : ROLE_CAR;
-            ESP_LOGI("ROLE", "Rolle entschieden: %s",
-                     s_role == ROLE_CONTROLLER ? "CONTROLLER (Sender)" : "CAR (Empfänger)");
+            role_set(ROLE_CAR);
+            ESP_LOGI("ROLE", "Rolle entschieden: CAR (Empfänger)");
+        }
+
+        // Kalibrierung nur auf dem Controller sichern; das Auto misst offene ADC-Eingänge
+        if (calib_dirty && s_role == ROLE_CONTROLLER && (now_ms2 - calib_changed_ms) >= JS_CALIB_SAVE_DELAY_MS) {
+            const esp_err_t save_err = joystick_calib_save(&cal_x, &cal_y);
+            if (save_err == ESP_OK) {
+                calib_dirty = false;
+                ESP_LOGI("JOYSTICK", "Kalibrierung gespeichert");
+            } else {
+                calib_changed_ms = now_ms2; // später erneut versuchen
+                ESP_LOGW("JOYSTICK", "Kalibrierung nicht gespeichert: %s", esp_err_to_name(save_err));
+            }
         }
 
-        // Wenn Controller -> Befehle senden
-        if (s_role == ROLE_CONTROLLER) {
+        // Wenn Controller -> Befehle senden: sofort bei Änderung, sonst nur als Keepalive
+        const bool changed = abs(x_pct - sent_x) >= JS_SEND_DELTA_PC ||
+                             abs(y_pct - sent_y) >= JS_SEND_DELTA_PC ||
+                             btn != sent_btn;
+        const bool keepalive_due = (now_ms2 - last_send_ms) >= JS_KEEPALIVE_MS;
+        if (s_role == ROLE_CONTROLLER && (changed || keepalive_due || atomic_exchange(&s_cmd_resend, false))) {
             // Paket bauen
             cmd_joystick_t pkt = {0};
             pkt.hdr.magic[0] = CMD_MAGIC0;
             pkt.hdr.magic[1] = CMD_MAGIC1;
             pkt.hdr.type = CMD_JOYSTICK;
             pkt.hdr.ver = CMD_PROTO_VER;
+            pkt.seq = cmd_seq++;
+            pkt.t_ms = now_ms32();
+            if (CMD_ECHO_EVERY > 0 && pkt.seq % CMD_ECHO_EVERY == 0) pkt.flags |= CMD_FLAG_ECHO_REQ;
             pkt.x_pct = x_pct;
             pkt.y_pct = y_pct;
             pkt.buttons = btn ? 0x01 : 0x00;
 
-            // 1) Broadcast
-            espnow_send(ESPNOW_BCAST_MAC, &pkt, sizeof(pkt));
-
-            // 2) Unicast zu bekannten Peers
-            for (int i = 0; i < ESPNOW_MAX_PEERS; ++i) {
-                if (s_known_peers[i].used) {
-                    esp_err_t err = espnow_send(s_known_peers[i].mac, &pkt, sizeof(pkt));
-                    if (err != ESP_OK) {
-                        ESP_LOGW("ESPNOW", "Cmd an %02X:%02X:%02X:%02X:%02X:%02X fehlgeschlagen: %s",
-                                 s_known_peers[i].mac[0], s_known_peers[i].mac[1], s_known_peers[i].mac[2],
-                                 s_known_peers[i].mac[3], s_known_peers[i].mac[4], s_known_peers[i].mac[5],
-                                 esp_err_to_name(err));
-                    }
-                }
+            // Einmal kodieren, an Broadcast + bekannte Peers verteilen. Asynchron: die Abtastung
+            // wartet nie auf den Funkkanal. Ist die TX-Warteschlange voll, bleibt der gesendete
+            // Zustand unverändert und der nächste Abtastwert versucht es erneut.
+            uint8_t targets[ESPNOW_MAX_FANOUT][6];
+            const size_t n_targets = collect_targets(targets);
+            const esp_err_t err = espnow_send_multi_async(targets, n_targets, &pkt, sizeof(pkt), on_cmd_sent, NULL);
+            if (err == ESP_OK) {
+                sent_x = x_pct;
+                sent_y = y_pct;
+                sent_btn = btn;
+                last_send_ms = now_ms2;
+            } else {
+                ESP_LOGD("ESPNOW", "Cmd verworfen: %s", esp_err_to_name(err));
             }
         }
 
@@ -316,26 +602,24 @@ void espnow_test_sender_task(void* arg)
     (void)arg;
     uint32_t counter = 0;
 
-    static const uint8_t BCAST[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-
     while (1)
     {
         test_payload_t p = {0};
         p.counter = counter++;
         snprintf(p.message, sizeof(p.message), "hello-%lu", (unsigned long)p.counter);
 
-        // 1) Broadcast (optional, zu Demo-Zwecken)
-        espnow_send(BCAST, &p, sizeof(p));
+        // Broadcast (optional, zu Demo-Zwecken) + Unicast an alle bekannten Peers, einmal kodiert
+        uint8_t targets[ESPNOW_MAX_FANOUT][6];
+        const size_t n_targets = collect_targets(targets);
 
-        // 2) Unicast an alle bekannten Peers
-        for (int i = 0; i < ESPNOW_MAX_PEERS; ++i) {
-            if (s_known_peers[i].used) {
-                esp_err_t err = espnow_send(s_known_peers[i].mac, &p, sizeof(p));
-                if (err != ESP_OK) {
+        esp_err_t status[ESPNOW_MAX_FANOUT];
+        if (espnow_send_multi(targets, n_targets, &p, sizeof(p), status) != ESP_OK) {
+            for (size_t i = 1; i < n_targets; ++i) {
+                if (status[i] != ESP_OK) {
                     ESP_LOGW("ESPNOW", "Send an %02X:%02X:%02X:%02X:%02X:%02X fehlgeschlagen: %s",
-                             s_known_peers[i].mac[0], s_known_peers[i].mac[1], s_known_peers[i].mac[2],
-                             s_known_peers[i].mac[3], s_known_peers[i].mac[4], s_known_peers[i].mac[5],
-                             esp_err_to_name(err));
+                             targets[i][0], targets[i][1], targets[i][2],
+                             targets[i][3], targets[i][4], targets[i][5],
+                             esp_err_to_name(status[i]));
                 }
             }
         }
@@ -345,53 +629,270 @@ void espnow_test_sender_task(void* arg)
 }
 
 
+#if !SENSOR_TELEMETRY_BATCHED
+// Ein Kanal als JSON; "value" ist der Mittelwert (Feldname wie bisher, siehe backend/telegraf.conf)
+static int format_sensor_stat(char* buf, const size_t size, const sensor_stat_t* st, const int decimals)
+{
+    const int n = snprintf(buf, size, "{\"value\":%.*f,\"min\":%.*f,\"max\":%.*f,\"n\":%lu}",
+                           decimals, sensor_stat_mean(st), decimals, st->min, decimals, st->max,
+                           (unsigned long) st->n);
+    return (n > 0 && (size_t) n < size) ? n : -1;
+}
+
+static void publish_sensor_stat(const char* topic, const sensor_stat_t* st, const int decimals)
+{
+    char buf[96];
+    if (st->n == 0) return;
+    const int len = format_sensor_stat(buf, sizeof(buf), st, decimals);
+    if (len > 0) mqtt_enqueue(topic, buf, len, 1, 0);
+}
+#else
+// Gesammelte Zeilen; nur im Publisher-Task benutzt
+static struct {
+    char buf[SENSOR_TELEMETRY_MAX_LEN];
+    size_t len;
+    uint8_t windows;
+} s_telemetry;
+
+static bool telemetry_flush(void)
+{
+    const bool sent = s_telemetry.len > 0;
+    if (sent) mqtt_enqueue(SENSOR_TELEMETRY_TOPIC, s_telemetry.buf, (int) s_telemetry.len, 1, 0);
+    s_telemetry.len = 0;
+    s_telemetry.windows = 0;
+    return sent;
+}
+
+// Hängt alle Treiber eines Fensters an und veröffentlicht nach SENSOR_TELEMETRY_WINDOWS Fenstern
+// in einem QoS-1-Publish: ein PUBACK und ein Outbox-Eintrag statt einem je Kanal. Die Zeitstempel
+// reisen in den Zeilen mit, ein Rückstau in der Outbox verschiebt die Zeitreihe daher nicht.
+// @return true, wenn eine Nachricht an MQTT übergeben wurde.
+static bool publish_sensor_batch(const sensor_window_t* win)
+{
+    bool stamped = true;
+    bool sent = false;
+    for (size_t i = 0; i < sensor_count(); ++i) {
+        const sensor_driver_t* drv = sensor_get(i);
+        const size_t room = sizeof(s_telemetry.buf) - s_telemetry.len;
+        int w = sensor_telemetry_format_line(s_telemetry.buf + s_telemetry.len, room, drv, win->stat[i], win->t_unix_us[i]);
+        if (w < 0 && s_telemetry.windows > 0) {
+            // Voll mit früheren Fenstern: erst diese senden, dann neu beginnen
+            sent |= telemetry_flush();
+            w = sensor_telemetry_format_line(s_telemetry.buf, sizeof(s_telemetry.buf), drv, win->stat[i], win->t_unix_us[i]);
+        }
+        if (w < 0) {
+            ESP_LOGW(TAG, "Telemetrie: %s passt nicht mehr in die Nachricht", drv->name);
+            continue;
+        }
+        s_telemetry.len += (size_t) w;
+        if (w > 0 && win->t_unix_us[i] == 0) stamped = false;
+    }
+    s_telemetry.windows++;
+    // Zeilen ohne Zeitstempel bekämen beim Sammeln die Ankunftszeit eines späteren Fensters
+    if (!stamped || s_telemetry.windows >= SENSOR_TELEMETRY_WINDOWS) sent |= telemetry_flush();
+    return sent;
+}
+#endif
+
+// Fenster vor der ersten MQTT-Verbindung, älteste zuerst; nur im Publisher-Task benutzt
+static struct {
+    sensor_window_t win[SENSOR_BACKLOG_WINDOWS];
+    uint8_t first;
+    uint8_t count;
+    uint32_t dropped;
+} s_backlog;
+
+// Hebt ein Fenster mit Zeitstempel auf; ist der Rückstau voll, weicht das älteste
+static void backlog_push(const sensor_window_t* win)
+{
+    bool stamped = false;
+    for (size_t i = 0; i < sensor_count(); ++i) stamped |= win->t_unix_us[i] != 0;
+    if (!SENSOR_TELEMETRY_BATCHED || !stamped) return;
+
+    if (s_backlog.count == SENSOR_BACKLOG_WINDOWS) {
+        s_backlog.first = (uint8_t) ((s_backlog.first + 1) % SENSOR_BACKLOG_WINDOWS);
+        s_backlog.count--;
+        s_backlog.dropped++;
+    }
+    s_backlog.win[(s_backlog.first + s_backlog.count) % SENSOR_BACKLOG_WINDOWS] = *win;
+    s_backlog.count++;
+}
+
+// Veröffentlicht alle Kanäle aller registrierten Sensoren eines Fensters.
+// @return true, wenn eine Nachricht an MQTT übergeben wurde.
+static bool publish_window(const sensor_window_t* win)
+{
+#if SENSOR_TELEMETRY_BATCHED
+    const bool published = publish_sensor_batch(win);
+#else
+    const bool published = true;
+#endif
+    for (size_t i = 0; i < sensor_count(); ++i) {
+        const sensor_driver_t* drv = sensor_get(i);
+        for (uint8_t c = 0; c < drv->n_channels; ++c) {
+            const sensor_channel_t* ch = &drv->channels[c];
+#if !SENSOR_TELEMETRY_BATCHED
+            char topic[48];
+            snprintf(topic, sizeof(topic), "/sensor/%s", ch->name);
+            publish_sensor_stat(topic, &win->stat[i][c], ch->decimals);
+#endif
+            ESP_LOGD(TAG, "%s/%s: %.*f %s (n=%lu)", drv->name, ch->name, ch->decimals,
+                     sensor_stat_mean(&win->stat[i][c]), ch->unit, (unsigned long) win->stat[i][c].n);
+        }
+    }
+    return published;
+}
+
+// Publisher: fasst die Datensätze des Sampler-Tasks je Fenster zusammen und veröffentlicht alle
+// Kanäle aller registrierten Sensoren (siehe SENSOR_TELEMETRY_BATCHED). Bis zur ersten
+// MQTT-Verbindung landen die Fenster im Rückstau (SENSOR_BACKLOG_WINDOWS) und gehen danach
+// in Messreihenfolge hinaus.
 [[noreturn]]
 void postSensorData(void *args)
 {
-    float temp = 0, pres = 0, hum = 0;
-    char tvoc_buf[16], eco2_buf[16], temp_buf[16], pres_buf[16], hum_buf[16];
+    sensor_window_t win;
+    uint32_t reported_drops = 0;
+    TickType_t last_wake = xTaskGetTickCount();
     while (1)
     {
-        vTaskDelay(10000 / portTICK_PERIOD_MS);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SENSOR_PUBLISH_PERIOD_MS));
 
-        // SGP30
-        sgp30_IAQ_measure(&main_sgp30_sensor);
+        // Ring immer leeren, damit der Sampler nicht ins Leere schreibt
+        if (sensor_window_collect(&win) == 0) continue;
 
-        // BME280
-        bmx280_setMode(bmx280, BMX280_MODE_FORCE);
-        while (bmx280_isSampling(bmx280))
-        {
-            vTaskDelay(pdMS_TO_TICKS(1));
+        const uint32_t drops = sensor_ring_drops();
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "Sensor-Ring voll, %lu Datensätze verworfen", (unsigned long) drops);
+            reported_drops = drops;
         }
-        ESP_ERROR_CHECK(bmx280_readoutFloat(bmx280, &temp, &pres, &hum));
-        pres /= 100; // Convert to hPa
-
-        const int tvoc_len = snprintf(tvoc_buf, sizeof(tvoc_buf), "%u", (unsigned) main_sgp30_sensor.TVOC);
-        const int eco2_len = snprintf(eco2_buf, sizeof(eco2_buf), "%u", (unsigned) main_sgp30_sensor.eCO2);
-        const int temp_len = snprintf(temp_buf, sizeof(temp_buf), "%.2f", temp);
-        const int pres_len = snprintf(pres_buf, sizeof(pres_buf), "%.2f", pres);
-#if !DISABLE_HUMIDITY
-        const int hum_len = snprintf(hum_buf, sizeof(hum_buf), "%.2f", hum);
-#endif
 
-        mqtt_enqueue("/sensor/tvoc", tvoc_buf, tvoc_len, 1, 0);
-        mqtt_enqueue("/sensor/eco2", eco2_buf, eco2_len, 1, 0);
-        mqtt_enqueue("/sensor/temperature", temp_buf, temp_len, 1, 0);
-        mqtt_enqueue("/sensor/pressure", pres_buf, pres_len, 1, 0);
-#if !DISABLE_HUMIDITY
-        mqtt_enqueue("/sensor/humidity", hum_buf, hum_len, 1, 0);
-#endif
+        if (!boot_stage_is_done(BOOT_MQTT)) {
+            backlog_push(&win);
+            continue;
+        }
 
-        ESP_LOGD(TAG, "TVOC: %s,  eCO2: %s, Temp: %s, Pres: %s, Hum: %s", tvoc_buf, eco2_buf, temp_buf, pres_buf, hum_buf);
-        //To debug on serial monitor:
-        //ESP_LOGI(TAG, "TVOC: %s,  eCO2: %s, Temp: %s, Pres: %s, Hum: %s", tvoc_buf, eco2_buf, temp_buf, pres_buf, hum_buf);
+        bool published = false;
+        if (s_backlog.count > 0) {
+            ESP_LOGI(TAG, "Sende %u Fenster aus der Zeit vor MQTT (%lu verworfen)",
+                     s_backlog.count, (unsigned long) s_backlog.dropped);
+            for (; s_backlog.count > 0; s_backlog.count--) {
+                published |= publish_window(&s_backlog.win[s_backlog.first]);
+                s_backlog.first = (uint8_t) ((s_backlog.first + 1) % SENSOR_BACKLOG_WINDOWS);
+            }
+        }
+        published |= publish_window(&win);
+
+        if (published && !boot_stage_is_done(BOOT_FIRST_PUBLISH)) {
+            boot_stage_done(BOOT_FIRST_PUBLISH);
+            boot_log_summary();
+        }
+    }
+}
+
+// Auto: Sensoren initialisieren und die SGP30-Baseline wiederherstellen, danach als Sampler-Task weiter.
+// Läuft parallel zu WLAN/MQTT, damit das Warten auf die Uhrzeit den Start nicht verzögert.
+[[noreturn]]
+static void sensor_boot_task(void *args)
+{
+    ESP_LOGI(TAG, "Konfiguriere I2C");
+    i2c_master_driver_initialize();
+
+    // Weitere Sensoren am selben Bus hier eintragen; Sampler und Publisher bleiben unverändert
+    ESP_LOGI(TAG, "Starte Sensoren");
+    sensor_register(&sensor_driver_sgp30);
+    sensor_register(&sensor_driver_bmx280);
+    if (sensor_registry_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Kein Sensor aktiv");
+    }
+    // Die SGP30-Baseline stellt der Treiber selbst wieder her, sobald NTP-Zeit vorliegt
+    boot_stage_done(BOOT_SENSORS);
+
+    sensor_sampler_task(args);
+}
+
+// Netz im Hintergrund: IP abwarten, danach Zeit holen. Fahren hängt davon nicht ab.
+static void network_boot_task(void *args)
+{
+    (void)args;
+    ESP_LOGI(TAG, "Warte auf WiFi Verbindung");
+    waitForSTAConnected(portMAX_DELAY);
+    boot_stage_done(BOOT_NET);
+
+    ntp_obtain_time();
+    boot_stage_done(BOOT_TIME);
+    vTaskDelete(NULL);
+}
+
+// Link-Statistik als JSON; "peer" wird in Telegraf zum Tag (siehe backend/telegraf.conf)
+static int format_link_stats(char* buf, const size_t size, const char* peer, const espnow_link_stats_t* l)
+{
+    static const uint32_t bounds[] = ESPNOW_LATENCY_BOUNDS_MS;
+    int n = snprintf(buf, size,
+                     "{\"peer\":\"%s\",\"tx_frames\":%lu,\"tx_failed\":%lu,\"rx_frames\":%lu,"
+                     "\"rx_messages\":%lu,\"frags_dropped\":%lu,\"reasm_timeouts\":%lu,"
+                     "\"dup_frags\":%lu,\"rssi\":%d",
+                     peer, (unsigned long) l->tx_frames, (unsigned long) l->tx_failed,
+                     (unsigned long) l->rx_frames, (unsigned long) l->rx_messages,
+                     (unsigned long) l->frags_dropped, (unsigned long) l->reasm_timeouts,
+                     (unsigned long) l->dup_frags, l->rssi_avg);
+    // send_*: unzuverlässig bis Sende-Callback, ack_*: zuverlässig bis Quittung
+    for (size_t h = 0; h < 2; ++h) {
+        const char *prefix = h == 0 ? "send" : "ack";
+        const uint32_t *hist = h == 0 ? l->send_latency_hist : l->ack_latency_hist;
+        for (size_t i = 0; i < ESPNOW_LATENCY_BUCKETS && n > 0 && (size_t) n < size; ++i) {
+            if (i + 1 < ESPNOW_LATENCY_BUCKETS) {
+                n += snprintf(buf + n, size - n, ",\"%s_lt%lums\":%lu", prefix,
+                              (unsigned long) bounds[i], (unsigned long) hist[i]);
+            } else {
+                n += snprintf(buf + n, size - n, ",\"%s_ge%lums\":%lu", prefix,
+                              (unsigned long) bounds[i - 1], (unsigned long) hist[i]);
+            }
+        }
+    }
+    if (n > 0 && (size_t) n < size) n += snprintf(buf + n, size - n, "}");
+    return (n > 0 && (size_t) n < size) ? n : -1;
+}
+
+// Veröffentlicht die ESPNOW-Link-Statistik aller Peers (Zähler kumulativ seit Start)
+[[noreturn]]
+void espnow_stats_task(void *args)
+{
+    (void)args;
+    static espnow_stats_t stats;
+    static char buf[768]; // reicht für 10-stellige Zähler in allen Feldern beider Histogramme
+    char topic[40];
+    char peer[18];
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(ESPNOW_STATS_INTERVAL_MS));
+        if (espnow_get_stats(&stats) != ESP_OK) continue;
+
+        for (size_t i = 0; i < stats.n_peers; ++i) {
+            const uint8_t* m = stats.peers[i].mac;
+            snprintf(peer, sizeof(peer), "%02x:%02x:%02x:%02x:%02x:%02x", m[0], m[1], m[2], m[3], m[4], m[5]);
+            snprintf(topic, sizeof(topic), "/espnow/stats/%02x%02x%02x%02x%02x%02x",
+                     m[0], m[1], m[2], m[3], m[4], m[5]);
+            const int len = format_link_stats(buf, sizeof(buf), peer, &stats.peers[i].link);
+            if (len > 0) mqtt_enqueue(topic, buf, len, 0, 0);
+        }
+
+        // Broadcast/unbekannte Absender, ergänzt um die Verluste des Empfangsrings
+        int len = format_link_stats(buf, sizeof(buf), "other", &stats.other);
+        if (len > 0) {
+            len--; // schließende Klammer ersetzen
+            len += snprintf(buf + len, sizeof(buf) - len, ",\"rx_ring_drops\":%lu}",
+                            (unsigned long) stats.rx_ring_drops);
+            if ((size_t) len < sizeof(buf)) mqtt_enqueue("/espnow/stats/other", buf, len, 0, 0);
+        }
     }
 }
 
 
 void app_main(void)
 {
-    vTaskDelay(pdMS_TO_TICKS(200));
+    // Startphasen laufen parallel und melden sich per boot_stage_done() (siehe boot.h):
+    // Fahren braucht nur NVS, Motoren, Wi-Fi-Treiber und ESPNOW, nicht Verbindung, NTP oder MQTT
+    boot_init();
 
     const esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
@@ -399,17 +900,30 @@ void app_main(void)
         ESP_ERROR_CHECK(nvs_flash_erase());
         ESP_ERROR_CHECK(nvs_flash_init());
     }
+    boot_stage_done(BOOT_NVS);
 
+    // Motoren vor ESPNOW: Steuerbefehle können ab dem ersten Empfang eintreffen
+    button_led_init();
+    setup_hw_timer_led();
+    motor_init();
+    registerKeyCallback(keyCallback);
+    boot_stage_done(BOOT_MOTOR);
+
+    // Startet nur den Treiber; die Verbindung baut sich im Hintergrund auf (network_boot_task)
     ESP_LOGI(TAG, "Konfiguriere WiFi");
     initSTA();
-
-    ESP_LOGI(TAG, "Warte auf WiFi Verbindung");
-    waitForSTAConnected(portMAX_DELAY);
-    ntp_obtain_time();
+    boot_stage_done(BOOT_WIFI_STARTED);
+    xTaskCreate(network_boot_task, "net_boot", 1024 * 3, NULL, 5, NULL);
 
     // ESPNOW initialisieren
     ESP_LOGI(TAG, "Initialisiere ESPNOW");
-    ESP_ERROR_CHECK(espnow_init(WIFI_IF_STA, on_espnow_recv, NULL));
+    // Empfang in eigener Task: on_espnow_recv sendet ACKs, loggt und steuert die Motoren
+    espnow_config_t espnow_cfg = ESPNOW_CONFIG_DEFAULT();
+    espnow_cfg.ifx = WIFI_IF_STA;
+    espnow_cfg.recv_cb = on_espnow_recv;
+    espnow_cfg.dispatch = ESPNOW_DISPATCH_TASK;
+    espnow_cfg.worker_priority = 10;
+    ESP_ERROR_CHECK(espnow_init_with_config(&espnow_cfg));
 
     // Optional: PMK setzen, falls Verschlüsselung gewünscht:
     // const uint8_t pmk[ESPNOW_KEY_LEN] = { /* 16 Bytes gemeinsamer Schlüssel */ };
@@ -426,38 +940,28 @@ void app_main(void)
 
     // Discovery-Task starten
     xTaskCreate(espnow_discovery_task, "espnow_disc", 2048, NULL, 8, NULL);
+    boot_stage_done(BOOT_ESPNOW);
 
     // Joystick + Rollenerkennung & Senden
     xTaskCreate(joystick_sender_task, "js_sender", 4096, NULL, 9, NULL);
 
-        button_led_init();
-        setup_hw_timer_led();
-        motor_init();
-        registerKeyCallback(keyCallback);
-
-    while (s_role == ROLE_UNKNOWN) {
-        vTaskDelay(500 / portTICK_PERIOD_MS);
-    }
+    boot_wait(BOOT_ROLE, portMAX_DELAY);
     if (s_role == ROLE_CONTROLLER) {
         return;
     }
 
-        ESP_LOGI(TAG, "Starte MQTT");
-        mqtt_app_start();
-
-        ESP_LOGI(TAG, "Konfiguriere I2C");
-        i2c_master_driver_initialize();
-
-        ESP_LOGI(TAG, "Starte Sensoren");
-        sensor_bmx280_init();
-        sensor_sgp30_init();
+    ESP_LOGI(TAG, "Starte Sensor Tasks");
+    xTaskCreate(sensor_boot_task, "sensor_sampler", 1024 * 3, 0, 10, NULL);
+    xTaskCreate(postSensorData, "sensor_publish", 1024 * 3, 0, 5, NULL);
 
-        ESP_LOGI(TAG, "Warte auf MQTT Verbindung");
-        mqtt_wait_connected(portMAX_DELAY);
+    boot_wait(BOOT_NET, portMAX_DELAY);
+    ESP_LOGI(TAG, "Starte MQTT");
+    mqtt_app_start();
 
-        ESP_LOGI(TAG, "Starte Sensor Task");
-        xTaskCreate(postSensorData, "sensor_task", 1024 * 2, 0, 10, NULL);
+    ESP_LOGI(TAG, "Warte auf MQTT Verbindung");
+    mqtt_wait_connected(portMAX_DELAY);
+    boot_stage_done(BOOT_MQTT);
 
+    ESP_LOGI(TAG, "Starte ESPNOW Statistik Task");
+    xTaskCreate(espnow_stats_task, "espnow_stats", 1024 * 3, 0, 5, NULL);
 }
-
-
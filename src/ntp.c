@@ -7,6 +7,15 @@ void time_sync_notification_cb(struct timeval *tv)
 	ESP_LOGI(TAG, "Zeit synchronisiert");
 }
 
+bool ntp_time_valid(void)
+{
+	time_t now;
+	struct tm timeInfo;
+	time(&now);
+	localtime_r(&now, &timeInfo);
+	return timeInfo.tm_year >= (2016 - 1900);
+}
+
 void ntp_obtain_time()
 {
 	esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
@@ -0,0 +1,155 @@
+#include "sensor_bus.h"
+
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "SensorBus";
+
+_Static_assert(SENSOR_BUS_TXNS_PER_DEV <= 32, "txn pool mask is 32 bit wide");
+
+struct sensor_bus_dev {
+    bool used;
+    uint8_t addr;
+    i2c_master_dev_handle_t handle;
+    atomic_uint txn_used;  // Bit i = txns[i] ausstehend
+    sensor_bus_txn_t txns[SENSOR_BUS_TXNS_PER_DEV];
+};
+
+static struct {
+    i2c_master_bus_handle_t bus;
+    QueueHandle_t queue;   // sensor_bus_txn_t* (Kopf eines Batches)
+    sensor_bus_dev_t devs[SENSOR_BUS_MAX_DEVICES];
+} g_ctx;
+
+void sensor_bus_txn_put(sensor_bus_txn_t *txn)
+{
+    sensor_bus_dev_t *dev = txn->dev;
+    const unsigned idx = (unsigned)(txn - dev->txns);
+    atomic_fetch_and_explicit(&dev->txn_used, ~(1u << idx), memory_order_release);
+}
+
+static void bus_task(void *arg)
+{
+    (void)arg;
+    sensor_bus_txn_t *txn;
+    for (;;) {
+        if (xQueueReceive(g_ctx.queue, &txn, portMAX_DELAY) != pdTRUE) continue;
+        while (txn) {
+            sensor_bus_txn_t *next = txn->next;
+            if (txn->delay_ms) vTaskDelay(pdMS_TO_TICKS(txn->delay_ms));
+            const esp_err_t err = sensor_bus_transfer(txn->dev, txn->tx, txn->tx_len, txn->rx, txn->rx_len);
+            if (err != ESP_OK) {
+                ESP_LOGD(TAG, "Transfer an 0x%02X fehlgeschlagen: %s", txn->dev->addr, esp_err_to_name(err));
+            }
+            if (txn->done) txn->done(txn, err, txn->user_ctx);
+            sensor_bus_txn_put(txn);
+            txn = next;
+        }
+    }
+}
+
+esp_err_t sensor_bus_init(void)
+{
+    if (g_ctx.bus) return ESP_OK;
+
+    const i2c_master_bus_config_t cfg = {
+        .i2c_port = CONFIG_I2C_MASTER_PORT_NUM,
+        .sda_io_num = CONFIG_I2C_MASTER_SDA,
+        .scl_io_num = CONFIG_I2C_MASTER_SCL,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    i2c_master_bus_handle_t bus = NULL;
+    esp_err_t err = i2c_new_master_bus(&cfg, &bus);
+    if (err != ESP_OK) return err;
+
+    g_ctx.queue = xQueueCreate(SENSOR_BUS_QUEUE_DEPTH, sizeof(sensor_bus_txn_t *));
+    if (!g_ctx.queue) goto fail;
+    // Priorität wie der Sampler; die Arbeit besteht fast nur aus Warten auf den Bus
+    if (xTaskCreate(bus_task, "sensor_bus", 3072, NULL, 10, NULL) != pdPASS) goto fail;
+    // Erst jetzt gilt der Bus als initialisiert, ein erneuter Aufruf nach Fehlern versucht es neu
+    g_ctx.bus = bus;
+    return ESP_OK;
+
+fail:
+    if (g_ctx.queue) vQueueDelete(g_ctx.queue);
+    i2c_del_master_bus(bus);
+    memset(&g_ctx, 0, sizeof(g_ctx));
+    return ESP_ERR_NO_MEM;
+}
+
+i2c_master_bus_handle_t sensor_bus_handle(void)
+{
+    return g_ctx.bus;
+}
+
+sensor_bus_dev_t *sensor_bus_device(const uint8_t addr)
+{
+    if (!g_ctx.bus) return NULL;
+    sensor_bus_dev_t *free_slot = NULL;
+    for (size_t i = 0; i < SENSOR_BUS_MAX_DEVICES; ++i) {
+        if (g_ctx.devs[i].used && g_ctx.devs[i].addr == addr) return &g_ctx.devs[i];
+        if (!g_ctx.devs[i].used && !free_slot) free_slot = &g_ctx.devs[i];
+    }
+    if (!free_slot) return NULL;
+
+    const i2c_device_config_t cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = CONFIG_I2C_MASTER_FREQUENCY,
+    };
+    if (i2c_master_bus_add_device(g_ctx.bus, &cfg, &free_slot->handle) != ESP_OK) return NULL;
+    free_slot->addr = addr;
+    atomic_store(&free_slot->txn_used, 0);
+    free_slot->used = true;
+    return free_slot;
+}
+
+esp_err_t sensor_bus_transfer(sensor_bus_dev_t *dev, const uint8_t *tx, const size_t tx_len,
+                              uint8_t *rx, const size_t rx_len)
+{
+    if (!dev || (tx_len == 0 && rx_len == 0)) return ESP_ERR_INVALID_ARG;
+    if (tx_len && rx_len) {
+        return i2c_master_transmit_receive(dev->handle, tx, tx_len, rx, rx_len, SENSOR_BUS_TIMEOUT_MS);
+    }
+    if (tx_len) return i2c_master_transmit(dev->handle, tx, tx_len, SENSOR_BUS_TIMEOUT_MS);
+    return i2c_master_receive(dev->handle, rx, rx_len, SENSOR_BUS_TIMEOUT_MS);
+}
+
+sensor_bus_txn_t *sensor_bus_txn_get(sensor_bus_dev_t *dev)
+{
+    if (!dev) return NULL;
+    unsigned used = atomic_load_explicit(&dev->txn_used, memory_order_relaxed);
+    for (;;) {
+        const unsigned free_bits = ~used & ((SENSOR_BUS_TXNS_PER_DEV == 32) ? ~0u : ((1u << SENSOR_BUS_TXNS_PER_DEV) - 1));
+        if (!free_bits) return NULL;
+        const unsigned idx = (unsigned)__builtin_ctz(free_bits);
+        if (atomic_compare_exchange_weak_explicit(&dev->txn_used, &used, used | (1u << idx),
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            sensor_bus_txn_t *txn = &dev->txns[idx];
+            memset(txn, 0, sizeof(*txn));
+            txn->dev = dev;
+            return txn;
+        }
+    }
+}
+
+esp_err_t sensor_bus_submit(sensor_bus_txn_t *head)
+{
+    if (!head) return ESP_ERR_INVALID_ARG;
+    if (!g_ctx.queue) return ESP_ERR_INVALID_STATE;
+    if (xQueueSend(g_ctx.queue, &head, 0) == pdTRUE) return ESP_OK;
+
+    while (head) {
+        sensor_bus_txn_t *next = head->next;
+        sensor_bus_txn_put(head);
+        head = next;
+    }
+    return ESP_ERR_TIMEOUT;
+}
@@ -0,0 +1,230 @@
+#include "sensor_registry.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ntp.h"
+
+static const char *TAG = "SensorRegistry";
+
+_Static_assert(sizeof(sensor_record_t) == 32, "sensor_record_t should stay compact");
+_Static_assert((SENSOR_RING_DEPTH & (SENSOR_RING_DEPTH - 1)) == 0, "ring depth must be a power of two");
+
+typedef struct {
+    const sensor_driver_t *drv;
+    bool active;        // init() erfolgreich
+    bool pending;       // gestartet, read() steht aus
+    int64_t due_us;     // nächster Messbeginn
+    int64_t ready_us;   // frühestes Auslesen der laufenden Messung
+    sensor_record_t rec;
+} sensor_slot_t;
+
+static struct {
+    sensor_slot_t slots[SENSOR_MAX_DRIVERS];
+    size_t count;
+    bool initialized;
+} g_ctx;
+
+// Datensatz-Ring: Sampler-Task (einziger Producer) an Publisher (einziger Consumer)
+static struct {
+    sensor_record_t slots[SENSOR_RING_DEPTH];
+    atomic_uint head;  // nur vom Producer geschrieben
+    atomic_uint tail;  // nur vom Consumer geschrieben
+    atomic_uint drops; // Datensätze verworfen, weil der Ring voll war
+} s_ring;
+
+static bool name_ok(const char *name)
+{
+    return name && name[0] != '\0' && strnlen(name, SENSOR_NAME_MAX_LEN + 1) <= SENSOR_NAME_MAX_LEN;
+}
+
+esp_err_t sensor_register(const sensor_driver_t *drv)
+{
+    if (g_ctx.initialized) return ESP_ERR_INVALID_STATE;
+    if (!drv || !drv->read || !drv->channels || drv->n_channels == 0 ||
+        drv->n_channels > SENSOR_MAX_CHANNELS || drv->period_ms == 0 ||
+        ((drv->caps & SENSOR_CAP_ASYNC) && !drv->start) || !name_ok(drv->name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Telemetrie- und Topic-Puffer sind auf diese Grenzen ausgelegt
+    for (uint8_t c = 0; c < drv->n_channels; ++c) {
+        if (!name_ok(drv->channels[c].name) || drv->channels[c].decimals > SENSOR_MAX_DECIMALS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (g_ctx.count >= SENSOR_MAX_DRIVERS) return ESP_ERR_NO_MEM;
+    g_ctx.slots[g_ctx.count++] = (sensor_slot_t){.drv = drv};
+    return ESP_OK;
+}
+
+esp_err_t sensor_registry_init(void)
+{
+    size_t active = 0;
+    const int64_t now_us = esp_timer_get_time();
+    for (size_t i = 0; i < g_ctx.count; ++i) {
+        sensor_slot_t *s = &g_ctx.slots[i];
+        const esp_err_t err = s->drv->init ? s->drv->init() : ESP_OK;
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%s nicht initialisiert (%s), bleibt inaktiv", s->drv->name, esp_err_to_name(err));
+            continue;
+        }
+        s->active = true;
+        s->due_us = now_us; // gleicher Start: Treiber mit gleicher Periode messen gemeinsam
+        active++;
+        ESP_LOGI(TAG, "%s aktiv, %u Kanäle alle %lu ms", s->drv->name, s->drv->n_channels,
+                 (unsigned long) s->drv->period_ms);
+    }
+    g_ctx.initialized = true;
+    return active ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+size_t sensor_count(void)
+{
+    return g_ctx.count;
+}
+
+const sensor_driver_t *sensor_get(const size_t idx)
+{
+    return idx < g_ctx.count ? g_ctx.slots[idx].drv : NULL;
+}
+
+void sensor_ring_push(const sensor_record_t *rec)
+{
+    const unsigned head = atomic_load_explicit(&s_ring.head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&s_ring.tail, memory_order_acquire);
+    if (head - tail >= SENSOR_RING_DEPTH) {
+        atomic_fetch_add_explicit(&s_ring.drops, 1, memory_order_relaxed);
+        return;
+    }
+    s_ring.slots[head & (SENSOR_RING_DEPTH - 1)] = *rec;
+    atomic_store_explicit(&s_ring.head, head + 1, memory_order_release);
+}
+
+static void stat_add(sensor_stat_t *s, const float v)
+{
+    if (s->n == 0 || v < s->min) s->min = v;
+    if (s->n == 0 || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+}
+
+size_t sensor_window_collect(sensor_window_t *out)
+{
+    *out = (sensor_window_t){0};
+    unsigned tail = atomic_load_explicit(&s_ring.tail, memory_order_relaxed);
+    while (tail != atomic_load_explicit(&s_ring.head, memory_order_acquire)) {
+        const sensor_record_t *rec = &s_ring.slots[tail & (SENSOR_RING_DEPTH - 1)];
+        if (rec->sensor < SENSOR_MAX_DRIVERS) {
+            for (uint8_t c = 0; c < rec->n_values && c < SENSOR_MAX_CHANNELS; ++c) {
+                if (rec->valid & (1u << c)) stat_add(&out->stat[rec->sensor][c], rec->values[c]);
+            }
+            if (rec->valid && rec->t_unix_us > out->t_unix_us[rec->sensor]) {
+                out->t_unix_us[rec->sensor] = rec->t_unix_us;
+            }
+        }
+        out->n_records++;
+        atomic_store_explicit(&s_ring.tail, ++tail, memory_order_release);
+    }
+    return out->n_records;
+}
+
+uint32_t sensor_ring_drops(void)
+{
+    return atomic_load_explicit(&s_ring.drops, memory_order_relaxed);
+}
+
+// Schläft bis zum esp_timer-Zeitpunkt t_us (aufgerundet auf ganze Ticks)
+static void sleep_until_us(const int64_t t_us)
+{
+    const int64_t remaining_us = t_us - esp_timer_get_time();
+    if (remaining_us <= 0) return;
+    const TickType_t ticks = (TickType_t) ((remaining_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+    vTaskDelay(ticks);
+}
+
+// Wanduhrzeit in µs; 0, solange NTP noch keine gültige Zeit gesetzt hat
+static int64_t wall_time_us(void)
+{
+    if (!ntp_time_valid()) return 0;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// Startet alle fälligen Treiber; ohne SENSOR_CAP_ASYNC ist die Messung sofort "fertig" und
+// läuft erst in read()
+static void start_due(const int64_t now_us)
+{
+    const int64_t wall_us = wall_time_us(); // Zeitstempel der Datensätze, gemeinsam für alle Treiber
+    for (size_t i = 0; i < g_ctx.count; ++i) {
+        sensor_slot_t *s = &g_ctx.slots[i];
+        if (!s->active || s->due_us > now_us) continue;
+
+        // Auf dem Raster der Periode bleiben; verpasste Termine werden nicht nachgeholt
+        s->due_us += (int64_t) s->drv->period_ms * 1000;
+        if (s->due_us <= now_us) s->due_us = now_us + (int64_t) s->drv->period_ms * 1000;
+
+        s->rec = (sensor_record_t){
+            .t_unix_us = wall_us,
+            .sensor = (uint8_t) i,
+            .n_values = s->drv->n_channels,
+        };
+        uint32_t ready_in_us = 0;
+        if (s->drv->caps & SENSOR_CAP_ASYNC) {
+            const esp_err_t err = s->drv->start(&ready_in_us);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "%s-Messung nicht gestartet: %s", s->drv->name, esp_err_to_name(err));
+                continue;
+            }
+        }
+        s->ready_us = now_us + ready_in_us;
+        s->pending = true;
+    }
+}
+
+// Liest die gestartete Messung mit der frühesten Fertigzeit; false, wenn keine aussteht
+static bool read_next(void)
+{
+    sensor_slot_t *next = NULL;
+    for (size_t i = 0; i < g_ctx.count; ++i) {
+        sensor_slot_t *s = &g_ctx.slots[i];
+        if (s->pending && (!next || s->ready_us < next->ready_us)) next = s;
+    }
+    if (!next) return false;
+
+    sleep_until_us(next->ready_us);
+    next->pending = false;
+    const esp_err_t err = next->drv->read(&next->rec);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s nicht gelesen: %s", next->drv->name, esp_err_to_name(err));
+        return true;
+    }
+    // Platzhalter aus der Anlaufphase belegen keinen Ringplatz
+    if ((next->drv->caps & SENSOR_CAP_WARMUP) && next->rec.valid == 0) return true;
+    sensor_ring_push(&next->rec);
+    return true;
+}
+
+void sensor_sampler_task(void *args)
+{
+    (void)args;
+    while (1)
+    {
+        int64_t next_due_us = INT64_MAX;
+        for (size_t i = 0; i < g_ctx.count; ++i) {
+            if (g_ctx.slots[i].active && g_ctx.slots[i].due_us < next_due_us) next_due_us = g_ctx.slots[i].due_us;
+        }
+        if (next_due_us == INT64_MAX) {
+            vTaskDelay(portMAX_DELAY); // kein aktiver Treiber
+            continue;
+        }
+        sleep_until_us(next_due_us);
+
+        start_due(esp_timer_get_time());
+        while (read_next()) {}
+    }
+}
@@ -0,0 +1,33 @@
+#include "sensor_telemetry.h"
+
+#include <stdio.h>
+
+int sensor_telemetry_format_line(char *buf, const size_t size, const sensor_driver_t *drv,
+                                 const sensor_stat_t *stat, const int64_t t_unix_us)
+{
+    int n = snprintf(buf, size, "sensor,sensor=%s", drv->name);
+    if (n < 0 || (size_t) n >= size) return -1;
+    char sep = ' ';
+    for (uint8_t c = 0; c < drv->n_channels; ++c) {
+        const sensor_stat_t *st = &stat[c];
+        if (st->n == 0) continue;
+        const char *name = drv->channels[c].name;
+        const int d = drv->channels[c].decimals;
+        const int w = snprintf(buf + n, size - n, "%c%s=%.*f,%s_min=%.*f,%s_max=%.*f,%s_n=%lui",
+                               sep, name, d, sensor_stat_mean(st), name, d, st->min, name, d, st->max,
+                               name, (unsigned long) st->n);
+        if (w < 0 || (size_t) w >= size - n) return -1;
+        n += w;
+        sep = ',';
+    }
+    if (sep == ' ') return 0;
+    if (t_unix_us > 0) {
+        const int w = snprintf(buf + n, size - n, " %lld000", (long long) t_unix_us);
+        if (w < 0 || (size_t) w >= size - n) return -1;
+        n += w;
+    }
+    if ((size_t) n + 1 >= size) return -1;
+    buf[n++] = '\n';
+    buf[n] = '\0';
+    return n;
+}
@@ -1,127 +1,371 @@
 #include "sensors.h"
+#include "sensor_bus.h"
+#include "ntp.h"
+#include "nvs.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <time.h>
+#include <string.h>
+#include <stdatomic.h>
 
-i2c_port_t i2c_num = CONFIG_I2C_MASTER_PORT_NUM;
-sgp30_dev_t main_sgp30_sensor;
-bmx280_t *bmx280;
+static sgp30_dev_t main_sgp30_sensor;
+static bmx280_t *bmx280;
 
 static const char *TAG = "SensorManager";
 
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint16_t eco2;
+    uint16_t tvoc;
+    int64_t saved_at; // Unix-Zeit in s
+} sgp30_baseline_record_t;
+
+static struct {
+    int64_t init_us;           // esp_timer-Zeit des IAQ-Init
+    int64_t baseline_valid_us; // ab hier ist die Baseline des Sensors sicherungswürdig
+    int64_t last_save_us;      // 0 = noch nie gesichert
+    bool restore_pending;      // gesicherte Baseline noch nicht versucht
+} g_sgp30;
+
+#define BMX280_SAMPLING_GRACE_TICKS 3
+
+static struct {
+    uint32_t conversion_us; // max. Dauer einer Forced-Messung mit der aktiven Konfiguration
+} g_bmx;
+
 esp_err_t i2c_master_driver_initialize(void)
 {
-    const int i2c_master_port = i2c_num;
-    i2c_config_t conf;
-
-    conf.mode = I2C_MODE_MASTER;
-    conf.sda_io_num = CONFIG_I2C_MASTER_SDA;
-    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.scl_io_num = CONFIG_I2C_MASTER_SCL;
-    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.master.clk_speed = CONFIG_I2C_MASTER_FREQUENCY;
-    conf.clk_flags = 0;
+    return sensor_bus_init();
+}
 
-    i2c_param_config(i2c_master_port, &conf);
-    return i2c_driver_install(I2C_NUM_0, I2C_MODE_MASTER, 0, 0, 0);
+// Sensor-Callbacks erwarten int8_t; esp_err_t nicht abschneiden, sonst könnte ein Fehler zu 0 werden
+static int8_t i2c_ret(const esp_err_t err)
+{
+    return err == ESP_OK ? 0 : -1;
 }
 
 int8_t main_i2c_read(const uint8_t reg_addr, uint8_t *reg_data, const uint32_t len, void *intf_ptr)
 {
-    // *intf_ptr = dev->intf_ptr
-    int8_t ret = 0; /* Return 0 for Success, non-zero for failure */
-
     if (len == 0)
     {
         return ESP_OK;
     }
 
-    const uint8_t chip_addr = *(uint8_t *) intf_ptr;
-
-    const i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-    i2c_master_start(cmd);
-
-    if (reg_addr != 0xff)
+    // *intf_ptr = dev->intf_ptr
+    sensor_bus_dev_t *dev = sensor_bus_device(*(uint8_t *) intf_ptr);
+    if (reg_addr != SENSOR_BUS_NO_REG)
     {
-        i2c_master_write_byte(cmd, (chip_addr << 1) | I2C_MASTER_WRITE, ACK_CHECK_EN);
-        i2c_master_write_byte(cmd, reg_addr, ACK_CHECK_EN);
-        i2c_master_start(cmd);
+        return i2c_ret(sensor_bus_transfer(dev, &reg_addr, 1, reg_data, len));
     }
+    return i2c_ret(sensor_bus_transfer(dev, NULL, 0, reg_data, len));
+}
 
-    i2c_master_write_byte(cmd, (chip_addr << 1) | I2C_MASTER_READ, ACK_CHECK_EN);
-
-    if (len > 1)
+int8_t main_i2c_write(const uint8_t reg_addr, const uint8_t *reg_data, const uint32_t len, void *intf_ptr)
+{
+    sensor_bus_dev_t *dev = sensor_bus_device(*(uint8_t *) intf_ptr);
+    if (reg_addr == SENSOR_BUS_NO_REG)
     {
-        i2c_master_read(cmd, reg_data, len - 1, ACK_VAL);
+        return i2c_ret(sensor_bus_transfer(dev, reg_data, len, NULL, 0));
     }
-    i2c_master_read_byte(cmd, reg_data + len - 1, NACK_VAL);
-    i2c_master_stop(cmd);
 
-    ret = i2c_master_cmd_begin(i2c_num, cmd, 1000 / portTICK_PERIOD_MS);
+    // Registerbyte und Nutzdaten in einem Transfer; Puffer auf dem Stack statt Command-Link vom Heap
+    uint8_t buf[SENSOR_BUS_TX_MAX];
+    if (len + 1 > sizeof(buf))
+    {
+        return i2c_ret(ESP_ERR_INVALID_SIZE);
+    }
+    buf[0] = reg_addr;
+    memcpy(buf + 1, reg_data, len);
+    return i2c_ret(sensor_bus_transfer(dev, buf, len + 1, NULL, 0));
+}
 
-    i2c_cmd_link_delete(cmd);
+static esp_err_t sgp30_driver_init(void)
+{
+    ESP_LOGI(TAG, "SGP30 main task initializing...");
+    sgp30_init(&main_sgp30_sensor, main_i2c_read, main_i2c_write);
+    g_sgp30.init_us = esp_timer_get_time();
+    g_sgp30.baseline_valid_us = g_sgp30.init_us + (int64_t)SGP30_BASELINE_LEARN_S * 1000000;
+    g_sgp30.last_save_us = 0;
+    g_sgp30.restore_pending = true;
+    return ESP_OK;
+}
 
-    return ret;
+bool sensor_sgp30_ready(void)
+{
+    return g_sgp30.init_us != 0 && esp_timer_get_time() - g_sgp30.init_us >= (int64_t)SGP30_INIT_PHASE_MS * 1000;
 }
 
-int8_t main_i2c_write(const uint8_t reg_addr, const uint8_t *reg_data, const uint32_t len, void *intf_ptr)
+// Stellt die im NVS gesicherte Baseline wieder her, wenn sie höchstens SGP30_BASELINE_MAX_AGE_S
+// alt ist. Ohne gültige Wanduhrzeit ESP_ERR_INVALID_STATE, bei zu alter ESP_ERR_TIMEOUT,
+// bei anderer Datensatzversion ESP_ERR_INVALID_VERSION, sonst Fehler von nvs_open()/nvs_get_blob().
+static esp_err_t sgp30_restore_baseline(void)
 {
-    int8_t ret = 0; /* Return 0 for Success, non-zero for failure */
+    if (!ntp_time_valid()) return ESP_ERR_INVALID_STATE;
 
-    const uint8_t chip_addr = *(uint8_t *) intf_ptr;
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(SGP30_BASELINE_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) return err;
+    sgp30_baseline_record_t rec;
+    size_t len = sizeof(rec);
+    err = nvs_get_blob(nvs, SGP30_BASELINE_NVS_KEY, &rec, &len);
+    nvs_close(nvs);
+    if (err != ESP_OK) return err;
+    if (len != sizeof(rec) || rec.version != SGP30_BASELINE_VERSION) return ESP_ERR_INVALID_VERSION;
 
-    const i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (chip_addr << 1) | I2C_MASTER_WRITE, ACK_CHECK_EN);
+    const int64_t age_s = (int64_t)time(NULL) - rec.saved_at;
+    if (age_s < 0 || age_s > SGP30_BASELINE_MAX_AGE_S) return ESP_ERR_TIMEOUT;
 
-    if (reg_addr != 0xFF)
-    {
-        i2c_master_write_byte(cmd, reg_addr, ACK_CHECK_EN);
+    sgp30_set_IAQ_baseline(&main_sgp30_sensor, rec.eco2, rec.tvoc);
+    // Wiederhergestellt ist sie sofort gültig; die nächste Sicherung folgt nach dem normalen Intervall
+    const int64_t now_us = esp_timer_get_time();
+    g_sgp30.baseline_valid_us = now_us;
+    g_sgp30.last_save_us = now_us;
+    ESP_LOGI(TAG, "SGP30 Baseline wiederhergestellt (eCO2: 0x%04X, TVOC: 0x%04X, Alter %lld h)",
+             rec.eco2, rec.tvoc, (long long)(age_s / 3600));
+    return ESP_OK;
+}
+
+esp_err_t sensor_sgp30_checkpoint_baseline(void)
+{
+    const int64_t now_us = esp_timer_get_time();
+    if (g_sgp30.init_us == 0 || now_us < g_sgp30.baseline_valid_us) return ESP_OK;
+    if (g_sgp30.last_save_us != 0 && now_us - g_sgp30.last_save_us < (int64_t)SGP30_BASELINE_SAVE_INTERVAL_S * 1000000) {
+        return ESP_OK;
     }
+    // Ohne Wanduhrzeit wäre das Alter beim nächsten Start nicht prüfbar
+    if (!ntp_time_valid()) return ESP_OK;
 
-    i2c_master_write(cmd, reg_data, len, ACK_CHECK_EN);
-    i2c_master_stop(cmd);
+    uint16_t eco2_baseline, tvoc_baseline;
+    sgp30_get_IAQ_baseline(&main_sgp30_sensor, &eco2_baseline, &tvoc_baseline);
+    const sgp30_baseline_record_t rec = {
+        .version = SGP30_BASELINE_VERSION,
+        .eco2 = eco2_baseline,
+        .tvoc = tvoc_baseline,
+        .saved_at = (int64_t)time(NULL)
+    };
 
-    ret = i2c_master_cmd_begin(i2c_num, cmd, 1000 / portTICK_PERIOD_MS);
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(SGP30_BASELINE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(nvs, SGP30_BASELINE_NVS_KEY, &rec, sizeof(rec));
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    if (err != ESP_OK) return err;
 
-    i2c_cmd_link_delete(cmd);
+    g_sgp30.last_save_us = now_us;
+    ESP_LOGI(TAG, "SGP30 Baseline gesichert (eCO2: 0x%04X, TVOC: 0x%04X)", eco2_baseline, tvoc_baseline);
+    return ESP_OK;
+}
 
-    return ret;
+// Oversampling-Faktor aus dem Registerwert (0 = Kanal abgeschaltet, 1..5 = x1..x16)
+static uint32_t bmx280_osrs_factor(const unsigned osrs)
+{
+    return osrs == 0 ? 0 : 1u << ((osrs > 5 ? 5 : osrs) - 1);
 }
 
-void sensor_sgp30_init()
+// Maximale Dauer einer Forced-Messung laut BME280-Datenblatt (Anhang B):
+// 1,25 ms + 2,3 ms * T + (2,3 ms * P + 0,575 ms) + (2,3 ms * H + 0,575 ms).
+// Der Feuchteanteil wird immer eingerechnet; beim BMP280 wartet das nur etwas länger.
+static uint32_t bmx280_conversion_us(const bmx280_config_t *cfg)
 {
-    ESP_LOGI(TAG, "SGP30 main task initializing...");
-    sgp30_init(&main_sgp30_sensor, main_i2c_read, main_i2c_write);
+    const uint32_t t = bmx280_osrs_factor(cfg->t_sampling);
+    const uint32_t p = bmx280_osrs_factor(cfg->p_sampling);
+    const uint32_t h = bmx280_osrs_factor(cfg->h_sampling);
+    uint32_t us = 1250 + 2300 * t;
+    if (p) us += 2300 * p + 575;
+    if (h) us += 2300 * h + 575;
+    return us;
+}
 
-    ESP_LOGI(TAG, "SGP30 Calibrating...");
-    for (int i = 0; i < 20; i++)
-    {
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        sgp30_IAQ_measure(&main_sgp30_sensor);
-        ESP_LOGD(TAG, "SGP30 Calibrating... TVOC: %d,  eCO2: %d", main_sgp30_sensor.TVOC, main_sgp30_sensor.eCO2);
+// Der Sampler weckt erst nach conversion_us; nur falls der Sensor dann noch misst (Toleranz
+// des Oszillators), wird kurz nachgewartet statt isSampling im Tick-Takt abzufragen
+static esp_err_t bmx280_driver_read(sensor_record_t *rec)
+{
+    for (int i = 0; i < BMX280_SAMPLING_GRACE_TICKS && bmx280_isSampling(bmx280); ++i) {
+        vTaskDelay(1);
     }
+    if (bmx280_isSampling(bmx280)) return ESP_ERR_TIMEOUT;
 
-    // Read initial baselines
-    uint16_t eco2_baseline, tvoc_baseline;
-    sgp30_get_IAQ_baseline(&main_sgp30_sensor, &eco2_baseline, &tvoc_baseline);
-    ESP_LOGI(TAG, "BASELINES - TVOC: %d,  eCO2: %d", tvoc_baseline, eco2_baseline);
+    float temp, pres, hum;
+    const esp_err_t err = bmx280_readoutFloat(bmx280, &temp, &pres, &hum);
+    if (err != ESP_OK) return err;
+    rec->values[0] = temp;
+    rec->values[1] = pres / 100; // Convert to hPa
+    rec->valid = 0x3;
+#if BMX280_HUMIDITY
+    rec->values[2] = hum;
+    rec->valid |= 0x4;
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t bmx280_driver_start(uint32_t *ready_in_us)
+{
+    const esp_err_t err = bmx280_setMode(bmx280, BMX280_MODE_FORCE);
+    *ready_in_us = g_bmx.conversion_us;
+    return err;
 }
 
-void sensor_bmx280_init()
+static esp_err_t bmx280_driver_init(void)
 {
     ESP_LOGI(TAG, "BMX280 main task initializing...");
-    bmx280 = bmx280_create(I2C_NUM_0);
+    bmx280 = bmx280_create_master(sensor_bus_handle());
 
     if (!bmx280)
     {
-        ESP_LOGE("test", "Could not create bmx280 driver.");
-        return;
+        ESP_LOGE(TAG, "Could not create bmx280 driver.");
+        return ESP_ERR_NO_MEM;
     }
 
-    ESP_ERROR_CHECK(bmx280_init(bmx280));
+    esp_err_t err = bmx280_init(bmx280);
+    if (err != ESP_OK) return err;
 
     bmx280_config_t bmx_cfg = BMX280_DEFAULT_CONFIG;
     bmx_cfg.t_standby = BMX280_STANDBY_1000M;
     bmx_cfg.iir_filter = BMX280_IIR_X4;
-    ESP_ERROR_CHECK(bmx280_configure(bmx280, &bmx_cfg));
-    ESP_ERROR_CHECK(bmx280_setMode(bmx280, BMX280_MODE_SLEEP));
+    err = bmx280_configure(bmx280, &bmx_cfg);
+    if (err == ESP_OK) err = bmx280_setMode(bmx280, BMX280_MODE_SLEEP);
+    if (err != ESP_OK) return err;
+
+    g_bmx.conversion_us = bmx280_conversion_us(&bmx_cfg);
+    ESP_LOGI(TAG, "BMX280 Konvertierungszeit max. %lu us", (unsigned long) g_bmx.conversion_us);
+    return ESP_OK;
+}
+
+static const sensor_channel_t s_bmx280_channels[] = {
+    {.name = "temperature", .unit = "°C",  .decimals = 2},
+    {.name = "pressure",    .unit = "hPa", .decimals = 2},
+#if BMX280_HUMIDITY
+    {.name = "humidity",    .unit = "%",   .decimals = 2},
+#endif
+};
+
+const sensor_driver_t sensor_driver_bmx280 = {
+    .name = "bmx280",
+    .caps = SENSOR_CAP_ASYNC,
+    .n_channels = sizeof(s_bmx280_channels) / sizeof(s_bmx280_channels[0]),
+    .channels = s_bmx280_channels,
+    .period_ms = BMX280_SAMPLE_PERIOD_MS,
+    .init = bmx280_driver_init,
+    .start = bmx280_driver_start,
+    .read = bmx280_driver_read,
+};
+
+// SGP30 Measure_air_quality als asynchroner Batch im Bus-Task: Kommando schreiben, nach der
+// Messzeit 2 Worte (eCO2, TVOC) mit je einer CRC lesen. Der Sampler wartet derweil auf den BMX280.
+#define SGP30_I2C_ADDR   0x58
+#define SGP30_MEASURE_MS 12
+
+static struct {
+    uint8_t cmd[2];
+    uint8_t reply[6];
+    TaskHandle_t waiter;
+    esp_err_t result;
+    atomic_bool pending; // Batch eingereicht, Abschluss-Callback steht aus
+} s_iaq = {.cmd = {0x20, 0x08}};
+
+// CRC-8 laut Datenblatt: Polynom 0x31, Startwert 0xFF
+static uint8_t sgp30_crc8(const uint8_t *data, const size_t len)
+{
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void on_iaq_read(sensor_bus_txn_t *txn, const esp_err_t result, void *user_ctx)
+{
+    (void)txn;
+    (void)user_ctx;
+    s_iaq.result = result;
+    atomic_store(&s_iaq.pending, false);
+    xTaskNotifyGive(s_iaq.waiter);
 }
+
+// Einmal, im ersten Zyklus mit gültiger Wanduhrzeit. Hat der Sensor bis dahin selbst eine
+// gültige Baseline gelernt, bleibt es bei dieser.
+static void sgp30_restore_once(void)
+{
+    if (!g_sgp30.restore_pending || !ntp_time_valid()) return;
+    g_sgp30.restore_pending = false;
+    if (esp_timer_get_time() >= g_sgp30.baseline_valid_us) return;
+
+    const esp_err_t err = sgp30_restore_baseline();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "SGP30 Baseline nicht wiederhergestellt (%s), lernt neu", esp_err_to_name(err));
+    }
+}
+
+static esp_err_t sgp30_driver_start(uint32_t *ready_in_us)
+{
+    *ready_in_us = SGP30_MEASURE_MS * 1000;
+    // Eine nach Timeout noch laufende Messung nutzt dieselben Puffer; erst abwarten
+    if (atomic_load(&s_iaq.pending)) return ESP_ERR_INVALID_STATE;
+    ulTaskNotifyTake(pdTRUE, 0); // verspätete Meldung einer früheren Messung verwerfen
+    // Kein Batch des SGP30 unterwegs: Set_iaq_baseline kann sich nicht mit einer Messung überschneiden
+    sgp30_restore_once();
+
+    sensor_bus_dev_t *dev = sensor_bus_device(SGP30_I2C_ADDR);
+    sensor_bus_txn_t *wr = sensor_bus_txn_get(dev);
+    sensor_bus_txn_t *rd = sensor_bus_txn_get(dev);
+    if (!wr || !rd) {
+        if (wr) sensor_bus_txn_put(wr);
+        if (rd) sensor_bus_txn_put(rd);
+        return ESP_ERR_NO_MEM;
+    }
+    s_iaq.waiter = xTaskGetCurrentTaskHandle();
+    wr->tx = s_iaq.cmd;
+    wr->tx_len = sizeof(s_iaq.cmd);
+    wr->next = rd;
+    rd->delay_ms = SGP30_MEASURE_MS;
+    rd->rx = s_iaq.reply;
+    rd->rx_len = sizeof(s_iaq.reply);
+    rd->done = on_iaq_read;
+    atomic_store(&s_iaq.pending, true);
+    const esp_err_t err = sensor_bus_submit(wr);
+    if (err != ESP_OK) atomic_store(&s_iaq.pending, false);
+    return err;
+}
+
+// Wartet auf den Batch aus sgp30_driver_start() und übernimmt eCO2/TVOC; gemessen wird auch in
+// der Anlaufphase, sonst driftet die Baseline
+static esp_err_t sgp30_driver_read(sensor_record_t *rec)
+{
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SGP30_MEASURE_MS + 4 * SENSOR_BUS_TIMEOUT_MS)) == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (s_iaq.result != ESP_OK) return s_iaq.result;
+    if (sgp30_crc8(&s_iaq.reply[0], 2) != s_iaq.reply[2] || sgp30_crc8(&s_iaq.reply[3], 2) != s_iaq.reply[5]) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    main_sgp30_sensor.eCO2 = (uint16_t)((s_iaq.reply[0] << 8) | s_iaq.reply[1]);
+    main_sgp30_sensor.TVOC = (uint16_t)((s_iaq.reply[3] << 8) | s_iaq.reply[4]);
+    rec->values[0] = main_sgp30_sensor.TVOC;
+    rec->values[1] = main_sgp30_sensor.eCO2;
+    rec->valid = sensor_sgp30_ready() ? 0x3 : 0;
+
+    const esp_err_t baseline_err = sensor_sgp30_checkpoint_baseline();
+    if (baseline_err != ESP_OK) {
+        ESP_LOGW(TAG, "SGP30 Baseline nicht gesichert: %s", esp_err_to_name(baseline_err));
+    }
+    return ESP_OK;
+}
+
+static const sensor_channel_t s_sgp30_channels[] = {
+    {.name = "tvoc", .unit = "ppb", .decimals = 1},
+    {.name = "eco2", .unit = "ppm", .decimals = 1},
+};
+
+const sensor_driver_t sensor_driver_sgp30 = {
+    .name = "sgp30",
+    .caps = SENSOR_CAP_ASYNC | SENSOR_CAP_WARMUP,
+    .n_channels = sizeof(s_sgp30_channels) / sizeof(s_sgp30_channels[0]),
+    .channels = s_sgp30_channels,
+    .period_ms = SGP30_SAMPLE_PERIOD_MS,
+    .init = sgp30_driver_init,
+    .start = sgp30_driver_start,
+    .read = sgp30_driver_read,
+};
@@ -6,7 +6,9 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_eap_client.h"
+#include "esp_timer.h"
 #include <string.h>
+#include <stdatomic.h>
 
 #include "secrets.h"
 
@@ -17,6 +19,39 @@ static const char *TAG_WIFI = "WifiManager";
 static EventGroupHandle_t wifi_event_group = NULL;
 static const int WIFI_CONNECTED_BIT = BIT0;
 
+// Assoziiert = Kanal vom AP vorgegeben (unabhängig davon, ob schon eine IP vorliegt)
+static atomic_bool s_associated = false;
+// Kanal ohne AP-Verbindung; wird nach jedem Verbindungsverlust wieder eingestellt
+static atomic_uint s_home_channel = WLAN_ESPNOW_CHANNEL;
+static uint32_t s_reconnect_delay_ms = WLAN_RECONNECT_MIN_MS;
+static esp_timer_handle_t s_reconnect_timer = NULL;
+
+static void on_reconnect_timer(void *arg)
+{
+    (void)arg;
+    esp_wifi_connect();
+}
+
+// Verbindungsversuche scannen alle Kanäle und unterbrechen damit ESPNOW; ohne erreichbaren AP
+// daher mit wachsendem Abstand wiederholen
+static void schedule_reconnect(void)
+{
+    if (!s_reconnect_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = on_reconnect_timer,
+            .name = "wifi_reconnect"
+        };
+        if (esp_timer_create(&args, &s_reconnect_timer) != ESP_OK) {
+            esp_wifi_connect();
+            return;
+        }
+    }
+    ESP_LOGW(TAG_WIFI, "Verbindung verloren, neuer Versuch in %lu ms", (unsigned long)s_reconnect_delay_ms);
+    esp_timer_stop(s_reconnect_timer); // ESP_ERR_INVALID_STATE, falls nicht aktiv: unkritisch
+    esp_timer_start_once(s_reconnect_timer, (uint64_t)s_reconnect_delay_ms * 1000);
+    s_reconnect_delay_ms = (s_reconnect_delay_ms * 2 > WLAN_RECONNECT_MAX_MS) ? WLAN_RECONNECT_MAX_MS : s_reconnect_delay_ms * 2;
+}
+
 void eventHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
 {
     ESP_LOGD(TAG_WIFI, "Event dispatched from event loop base=%s, event_id=%ld",
@@ -24,19 +59,28 @@ void eventHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void
 
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
     {
+        esp_wifi_set_channel((uint8_t)atomic_load(&s_home_channel), WIFI_SECOND_CHAN_NONE);
         esp_wifi_connect();
     }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        const wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *) event_data;
+        atomic_store(&s_associated, true);
+        ESP_LOGI(TAG_WIFI, "Mit AP assoziiert, Kanal %u", (unsigned)event->channel);
+    }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
     {
-        ESP_LOGW(TAG_WIFI, "Verbindung verloren, versuche erneut...");
-        // TODO: Backoff/Timer einbauen statt sofort
-        esp_wifi_connect();
+        atomic_store(&s_associated, false);
         if (wifi_event_group) xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        // Zurück auf den eigenen Kanal, damit ESPNOW zwischen den Versuchen erreichbar bleibt
+        esp_wifi_set_channel((uint8_t)atomic_load(&s_home_channel), WIFI_SECOND_CHAN_NONE);
+        schedule_reconnect();
     }
     else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
     {
         const ip_event_got_ip_t *event = (ip_event_got_ip_t *) event_data;
         ESP_LOGI(TAG_WIFI, "Verbunden, IP: " IPSTR, IP2STR(&event->ip_info.ip));
+        s_reconnect_delay_ms = WLAN_RECONNECT_MIN_MS;
         if (wifi_event_group) xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
     }
 }
@@ -121,7 +165,29 @@ void initSTA(void)
 bool waitForSTAConnected(const TickType_t timeout)
 {
     if (!wifi_event_group) return false;
-    xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+    // Bit nicht vorher löschen: ist die IP schon da, kehrt der Aufruf sofort zurück
     const EventBits_t bits = xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, timeout);
     return (bits & WIFI_CONNECTED_BIT) != 0;
 }
+
+bool wlan_sta_associated(void)
+{
+    return atomic_load(&s_associated);
+}
+
+uint8_t wlan_get_channel(void)
+{
+    uint8_t primary = 0;
+    wifi_second_chan_t second = WIFI_SECOND_CHAN_NONE;
+    if (esp_wifi_get_channel(&primary, &second) != ESP_OK) return 0;
+    return primary;
+}
+
+esp_err_t wlan_set_channel(const uint8_t channel)
+{
+    if (channel < 1 || channel > WLAN_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    if (atomic_load(&s_associated)) return ESP_ERR_INVALID_STATE;
+    const esp_err_t err = esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    if (err == ESP_OK) atomic_store(&s_home_channel, channel);
+    return err;
+}
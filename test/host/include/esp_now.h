@@ -0,0 +1,63 @@
+// Host-Shim: esp_now-API mit den Fehlercodes und Grenzen aus ESP-IDF.
+// Frames laufen über das simulierte Funkmedium aus espnow_sim.h.
+#ifndef HOST_ESP_NOW_H
+#define HOST_ESP_NOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#define ESP_NOW_ETH_ALEN             6
+#define ESP_NOW_KEY_LEN              16
+#define ESP_NOW_MAX_DATA_LEN         250
+#define ESP_NOW_MAX_TOTAL_PEER_NUM   20
+#define ESP_NOW_MAX_ENCRYPT_PEER_NUM 7
+
+#define ESP_ERR_ESPNOW_BASE      0x3000
+#define ESP_ERR_ESPNOW_NOT_INIT  (ESP_ERR_ESPNOW_BASE + 101)
+#define ESP_ERR_ESPNOW_ARG       (ESP_ERR_ESPNOW_BASE + 102)
+#define ESP_ERR_ESPNOW_NO_MEM    (ESP_ERR_ESPNOW_BASE + 103)
+#define ESP_ERR_ESPNOW_FULL      (ESP_ERR_ESPNOW_BASE + 104)
+#define ESP_ERR_ESPNOW_NOT_FOUND (ESP_ERR_ESPNOW_BASE + 105)
+#define ESP_ERR_ESPNOW_INTERNAL  (ESP_ERR_ESPNOW_BASE + 106)
+#define ESP_ERR_ESPNOW_EXIST     (ESP_ERR_ESPNOW_BASE + 107)
+#define ESP_ERR_ESPNOW_IF        (ESP_ERR_ESPNOW_BASE + 108)
+
+typedef enum {
+    ESP_NOW_SEND_SUCCESS = 0,
+    ESP_NOW_SEND_FAIL,
+} esp_now_send_status_t;
+
+typedef struct {
+    uint8_t peer_addr[ESP_NOW_ETH_ALEN];
+    uint8_t lmk[ESP_NOW_KEY_LEN];
+    uint8_t channel;
+    wifi_interface_t ifidx;
+    bool encrypt;
+    void* priv;
+} esp_now_peer_info_t;
+
+typedef struct {
+    uint8_t* src_addr;
+    uint8_t* des_addr;
+    wifi_pkt_rx_ctrl_t* rx_ctrl;
+} esp_now_recv_info_t;
+
+typedef void (*esp_now_recv_cb_t)(const esp_now_recv_info_t* recv_info, const uint8_t* data, int len);
+typedef void (*esp_now_send_cb_t)(const wifi_tx_info_t* tx_info, esp_now_send_status_t status);
+
+esp_err_t esp_now_init(void);
+esp_err_t esp_now_deinit(void);
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+esp_err_t esp_now_unregister_recv_cb(void);
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb);
+esp_err_t esp_now_unregister_send_cb(void);
+esp_err_t esp_now_send(const uint8_t* peer_addr, const uint8_t* data, size_t len);
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer);
+esp_err_t esp_now_del_peer(const uint8_t* peer_addr);
+bool esp_now_is_peer_exist(const uint8_t* peer_addr);
+esp_err_t esp_now_set_pmk(const uint8_t* pmk);
+
+#endif // HOST_ESP_NOW_H
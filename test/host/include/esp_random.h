@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+
+// Pseudozufall (xorshift32) mit festem Startwert: reproduzierbar, aber über espnow_deinit()/
+// espnow_init() hinweg fortlaufend wie der Hardware-RNG über einen Neustart
+uint32_t esp_random(void);
+
+#endif // HOST_ESP_RANDOM_H
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_SNTP_H
+#define HOST_ESP_SNTP_H
+
+#include <stdbool.h>
+#include <sys/time.h>
+
+// Nur die Typen, die include/ntp.h braucht; SNTP selbst gibt es im Host-Build nicht
+
+#endif // HOST_ESP_SNTP_H
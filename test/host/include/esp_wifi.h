@@ -0,0 +1,36 @@
+// Host-Shim: nur die Wi-Fi-Typen, die die ESPNOW-Schicht berührt
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    WIFI_IF_STA = 0,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef struct {
+    int8_t rssi;
+    uint8_t channel;
+    int8_t noise_floor;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+    uint8_t* des_addr;
+    uint8_t* src_addr;
+} wifi_tx_info_t;
+
+// Immer WIFI_MODE_STA; die MAC kommt aus espnow_sim_config_t::own_mac
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode);
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]);
+
+#endif // HOST_ESP_WIFI_H
@@ -0,0 +1,90 @@
+#ifndef HTWK_C960_IOT_ESPNOW_SIM_H
+#define HTWK_C960_IOT_ESPNOW_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Simuliertes Funkmedium hinter dem esp_now-Host-Shim.
+ *
+ * Loopback: jeder per esp_now_send() verschickte Frame kommt (nach Verlust,
+ * Laufzeit, Umordnung und Duplikation) wieder am eigenen Empfangs-Callback an,
+ * und zwar mit der Ziel-MAC als Absender. Ein einzelner Knoten spielt damit
+ * Sender und Empfänger zugleich: Antworten (NACKs) an "den Absender" laufen
+ * ebenfalls zurück und treffen die Senderseite. Broadcasts erscheinen mit
+ * bcast_src als Absender.
+ *
+ * Callbacks kommen aus einem eigenen Simulator-Thread, wie im Wi-Fi-Task.
+ */
+
+typedef struct {
+    uint32_t seed;             // Startwert des Zufallsgenerators (reproduzierbare Läufe)
+    float loss;                // Verlustwahrscheinlichkeit je Frame (0..1)
+    float duplicate;           // Wahrscheinlichkeit, dass ein Frame doppelt ankommt
+    float reorder;             // Wahrscheinlichkeit, dass ein Frame um reorder_delay_ms zurückgehalten wird
+    uint32_t latency_ms;       // feste Laufzeit je Frame
+    uint32_t jitter_ms;        // zusätzliche gleichverteilte Laufzeit 0..jitter_ms
+    uint32_t reorder_delay_ms; // Verzögerung umgeordneter Frames
+    uint32_t phy_rate_kbps;    // Bitrate des Kanals für die Sendedauer (0 = unendlich schnell)
+    uint8_t tx_buffer_frames;  // Frames ohne Sende-Callback, ab denen esp_now_send NO_MEM meldet
+    int8_t rssi;               // RSSI, der an empfangene Frames gehängt wird
+    uint8_t own_mac[6];        // Ergebnis von esp_wifi_get_mac()
+    uint8_t bcast_src[6];      // Absender, mit dem Broadcasts zurückkommen
+} espnow_sim_config_t;
+
+#define ESPNOW_SIM_CONFIG_DEFAULT() {                        \
+    .seed = 1,                                               \
+    .loss = 0.0f,                                            \
+    .duplicate = 0.0f,                                       \
+    .reorder = 0.0f,                                         \
+    .latency_ms = 1,                                         \
+    .jitter_ms = 0,                                          \
+    .reorder_delay_ms = 5,                                   \
+    .phy_rate_kbps = 1000,                                   \
+    .tx_buffer_frames = 16,                                  \
+    .rssi = -40,                                             \
+    .own_mac = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01},         \
+    .bcast_src = {0x02, 0x00, 0x00, 0x00, 0x00, 0xB0},       \
+}
+
+typedef struct {
+    uint32_t sent;        // von esp_now_send angenommene Frames
+    uint32_t lost;        // verworfene Frames
+    uint32_t duplicated;  // zusätzlich zugestellte Kopien
+    uint32_t reordered;   // zurückgehaltene Frames
+    uint32_t delivered;   // an den Empfangs-Callback übergebene Frames
+    uint32_t driver_busy; // esp_now_send-Aufrufe mit ESP_ERR_ESPNOW_NO_MEM
+} espnow_sim_stats_t;
+
+/**
+ * Beobachter für jeden angenommenen Sendeframe (vor Verlust/Duplikation).
+ * Läuft im Kontext des esp_now_send-Aufrufers.
+ */
+typedef void (*espnow_sim_tx_hook_t)(const uint8_t peer_mac[6], const uint8_t *data, size_t len, void *user_ctx);
+
+/**
+ * Setzt Kanalparameter und Zähler zurück. Darf vor und nach esp_now_init()
+ * aufgerufen werden; bereits unterwegs befindliche Frames behalten ihr Schicksal.
+ */
+void espnow_sim_configure(const espnow_sim_config_t *cfg);
+
+void espnow_sim_get_stats(espnow_sim_stats_t *out);
+
+void espnow_sim_set_tx_hook(espnow_sim_tx_hook_t hook, void *user_ctx);
+
+/**
+ * Stellt einen beliebigen Rohframe zu, als käme er von src_mac über die Luft
+ * (ohne Verlust/Laufzeit). Für Fuzz-Tests.
+ */
+void espnow_sim_inject(const uint8_t src_mac[6], const uint8_t *data, size_t len);
+
+/**
+ * Wartet, bis keine Frames oder Sende-Callbacks mehr unterwegs sind.
+ *
+ * @param timeout_ms Maximale Wartezeit.
+ * @return true wenn das Medium leer ist, false bei Timeout.
+ */
+bool espnow_sim_flush(uint32_t timeout_ms);
+
+#endif //HTWK_C960_IOT_ESPNOW_SIM_H
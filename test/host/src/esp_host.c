@@ -0,0 +1,88 @@
+// ESP-IDF-Hilfsfunktionen für den nativen Build: Fehlernamen, Logging, Zeit, Wi-Fi-Abfragen.
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+// Standard WARN, damit Benchmarks nicht im Log untergehen
+static esp_log_level_t s_log_level = ESP_LOG_WARN;
+
+const char* esp_err_to_name(const esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                   return "ESP_OK";
+        case ESP_FAIL:                 return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_ESPNOW_NOT_INIT:  return "ESP_ERR_ESPNOW_NOT_INIT";
+        case ESP_ERR_ESPNOW_ARG:       return "ESP_ERR_ESPNOW_ARG";
+        case ESP_ERR_ESPNOW_NO_MEM:    return "ESP_ERR_ESPNOW_NO_MEM";
+        case ESP_ERR_ESPNOW_FULL:      return "ESP_ERR_ESPNOW_FULL";
+        case ESP_ERR_ESPNOW_NOT_FOUND: return "ESP_ERR_ESPNOW_NOT_FOUND";
+        case ESP_ERR_ESPNOW_INTERNAL:  return "ESP_ERR_ESPNOW_INTERNAL";
+        case ESP_ERR_ESPNOW_EXIST:     return "ESP_ERR_ESPNOW_EXIST";
+        case ESP_ERR_ESPNOW_IF:        return "ESP_ERR_ESPNOW_IF";
+        default:                       return "UNKNOWN ERROR";
+    }
+}
+
+void esp_log_level_set(const char* tag, const esp_log_level_t level) {
+    (void)tag; // ein globaler Level genügt auf dem Host
+    s_log_level = level;
+}
+
+void esp_log_write(const esp_log_level_t level, const char* tag, const char* format, ...) {
+    if (level > s_log_level) return;
+    static const char letters[] = "NEWIDV";
+    fprintf(stderr, "%c (%s) ", letters[level], tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+static int64_t s_time_start_us;
+static pthread_once_t s_time_once = PTHREAD_ONCE_INIT;
+
+static int64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void time_init(void) { s_time_start_us = monotonic_us(); }
+
+int64_t esp_timer_get_time(void) {
+    pthread_once(&s_time_once, time_init);
+    return monotonic_us() - s_time_start_us;
+}
+
+uint32_t esp_random(void) {
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static uint32_t state = 0x9E3779B9u;
+    pthread_mutex_lock(&lock);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    const uint32_t r = state;
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode) {
+    if (!mode) return ESP_ERR_INVALID_ARG;
+    *mode = WIFI_MODE_STA;
+    return ESP_OK;
+}
@@ -0,0 +1,416 @@
+// esp_now-Shim mit simuliertem Funkmedium (siehe espnow_sim.h).
+//
+// Modell: ein gemeinsamer Kanal mit fester Bitrate. Jeder Frame belegt ihn für seine
+// Sendedauer; danach feuert der Sende-Callback (Unicast: FAIL bei Verlust, Broadcast
+// immer SUCCESS) und nach latency + jitter (+ reorder_delay) der Empfangs-Callback.
+// Alle Callbacks laufen im Simulator-Thread, in Fälligkeitsreihenfolge.
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "espnow_sim.h"
+
+// Zusätzliche Bytes je Frame auf der Luft (MAC-Header, Vendor-IE, FCS)
+#define SIM_FRAME_OVERHEAD 43
+#define SIM_MAX_EVENTS     512
+
+typedef enum {
+    SIM_EV_TX_DONE,
+    SIM_EV_RX,
+} sim_event_kind_t;
+
+typedef struct {
+    bool used;
+    sim_event_kind_t kind;
+    uint64_t due_us;
+    uint64_t order;                 // stabile Reihenfolge bei gleichem Fälligkeitszeitpunkt
+    esp_now_send_status_t status;   // nur SIM_EV_TX_DONE
+    uint8_t mac[6];                 // TX_DONE: Ziel, RX: Absender
+    uint16_t len;
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} sim_event_t;
+
+static struct {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    bool stop;
+
+    espnow_sim_config_t cfg;
+    espnow_sim_stats_t stats;
+    uint32_t rng;
+
+    esp_now_recv_cb_t recv_cb;
+    esp_now_send_cb_t send_cb;
+    espnow_sim_tx_hook_t tx_hook;
+    void* tx_hook_ctx;
+
+    esp_now_peer_info_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM];
+    bool peer_used[ESP_NOW_MAX_TOTAL_PEER_NUM];
+
+    sim_event_t events[SIM_MAX_EVENTS];
+    uint32_t n_events;
+    uint64_t next_order;
+    uint64_t channel_free_us;
+    uint32_t pending_tx;            // Frames ohne Sende-Callback
+    bool dispatching;               // Simulator-Thread ruft gerade einen Callback auf
+} s_sim = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+    .cfg = ESPNOW_SIM_CONFIG_DEFAULT(),
+    .rng = 1,
+};
+
+static const uint8_t s_bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static pthread_once_t s_cond_once = PTHREAD_ONCE_INIT;
+
+// Bedingungsvariable mit monotoner Uhr; lässt sich nicht statisch initialisieren
+static void cond_init(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&s_sim.cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// xorshift32: schnell und über seed reproduzierbar
+static uint32_t rng_next(void) {
+    uint32_t x = s_sim.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_sim.rng = x;
+    return x;
+}
+
+static bool rng_chance(const float p) {
+    if (p <= 0.0f) return false;
+    if (p >= 1.0f) return true;
+    return (float)(rng_next() >> 8) / (float)(1u << 24) < p;
+}
+
+// Aufrufer hält mtx
+static bool event_push(const sim_event_kind_t kind, const uint64_t due_us, const uint8_t mac[6],
+                       const uint8_t* data, const size_t len, const esp_now_send_status_t status) {
+    if (s_sim.n_events >= SIM_MAX_EVENTS) return false;
+    for (size_t i = 0; i < SIM_MAX_EVENTS; ++i) {
+        sim_event_t* e = &s_sim.events[i];
+        if (e->used) continue;
+        e->used = true;
+        e->kind = kind;
+        e->due_us = due_us;
+        e->order = s_sim.next_order++;
+        e->status = status;
+        memcpy(e->mac, mac, 6);
+        e->len = (uint16_t)len;
+        if (len > 0) memcpy(e->data, data, len);
+        s_sim.n_events++;
+        pthread_cond_broadcast(&s_sim.cond);
+        return true;
+    }
+    return false;
+}
+
+// Aufrufer hält mtx
+static sim_event_t* event_earliest(void) {
+    sim_event_t* best = NULL;
+    for (size_t i = 0; i < SIM_MAX_EVENTS; ++i) {
+        sim_event_t* e = &s_sim.events[i];
+        if (!e->used) continue;
+        if (!best || e->due_us < best->due_us || (e->due_us == best->due_us && e->order < best->order)) best = e;
+    }
+    return best;
+}
+
+static void* sim_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&s_sim.mtx);
+    while (!s_sim.stop) {
+        sim_event_t* e = event_earliest();
+        if (!e) {
+            pthread_cond_wait(&s_sim.cond, &s_sim.mtx);
+            continue;
+        }
+        const uint64_t now = now_us();
+        if (e->due_us > now) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            const uint64_t wait_ns = (e->due_us - now) * 1000u + (uint64_t)ts.tv_nsec;
+            ts.tv_sec += (time_t)(wait_ns / 1000000000u);
+            ts.tv_nsec = (long)(wait_ns % 1000000000u);
+            pthread_cond_timedwait(&s_sim.cond, &s_sim.mtx, &ts);
+            continue;
+        }
+
+        // Ereignis kopieren und Mutex für den Callback freigeben (Callbacks dürfen senden)
+        const sim_event_t ev = *e;
+        e->used = false;
+        s_sim.n_events--;
+        if (ev.kind == SIM_EV_TX_DONE) s_sim.pending_tx--;
+        else s_sim.stats.delivered++;
+        const esp_now_recv_cb_t recv_cb = s_sim.recv_cb;
+        const esp_now_send_cb_t send_cb = s_sim.send_cb;
+        wifi_pkt_rx_ctrl_t rx_ctrl = {.rssi = s_sim.cfg.rssi, .channel = 1, .noise_floor = -95};
+        uint8_t own_mac[6];
+        memcpy(own_mac, s_sim.cfg.own_mac, 6);
+        s_sim.dispatching = true;
+        pthread_mutex_unlock(&s_sim.mtx);
+
+        if (ev.kind == SIM_EV_TX_DONE) {
+            if (send_cb) {
+                uint8_t des[6];
+                memcpy(des, ev.mac, 6);
+                const wifi_tx_info_t info = {.des_addr = des, .src_addr = own_mac};
+                send_cb(&info, ev.status);
+            }
+        } else if (recv_cb) {
+            uint8_t src[6];
+            memcpy(src, ev.mac, 6);
+            const esp_now_recv_info_t info = {.src_addr = src, .des_addr = own_mac, .rx_ctrl = &rx_ctrl};
+            recv_cb(&info, ev.data, ev.len);
+        }
+
+        pthread_mutex_lock(&s_sim.mtx);
+        s_sim.dispatching = false;
+        pthread_cond_broadcast(&s_sim.cond);
+    }
+    pthread_mutex_unlock(&s_sim.mtx);
+    return NULL;
+}
+
+void espnow_sim_configure(const espnow_sim_config_t* cfg) {
+    pthread_mutex_lock(&s_sim.mtx);
+    s_sim.cfg = *cfg;
+    s_sim.rng = cfg->seed ? cfg->seed : 1;
+    memset(&s_sim.stats, 0, sizeof(s_sim.stats));
+    pthread_mutex_unlock(&s_sim.mtx);
+}
+
+void espnow_sim_get_stats(espnow_sim_stats_t* out) {
+    pthread_mutex_lock(&s_sim.mtx);
+    *out = s_sim.stats;
+    pthread_mutex_unlock(&s_sim.mtx);
+}
+
+void espnow_sim_set_tx_hook(const espnow_sim_tx_hook_t hook, void* user_ctx) {
+    pthread_mutex_lock(&s_sim.mtx);
+    s_sim.tx_hook = hook;
+    s_sim.tx_hook_ctx = user_ctx;
+    pthread_mutex_unlock(&s_sim.mtx);
+}
+
+void espnow_sim_inject(const uint8_t src_mac[6], const uint8_t* data, const size_t len) {
+    if (!data || len == 0 || len > ESP_NOW_MAX_DATA_LEN) return;
+    pthread_once(&s_cond_once, cond_init);
+    pthread_mutex_lock(&s_sim.mtx);
+    event_push(SIM_EV_RX, now_us(), src_mac, data, len, ESP_NOW_SEND_SUCCESS);
+    pthread_mutex_unlock(&s_sim.mtx);
+}
+
+bool espnow_sim_flush(const uint32_t timeout_ms) {
+    const uint64_t deadline = now_us() + (uint64_t)timeout_ms * 1000u;
+    pthread_mutex_lock(&s_sim.mtx);
+    bool idle = false;
+    while (!(idle = (s_sim.n_events == 0 && !s_sim.dispatching)) && now_us() < deadline) {
+        pthread_mutex_unlock(&s_sim.mtx);
+        const struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000L};
+        nanosleep(&ts, NULL);
+        pthread_mutex_lock(&s_sim.mtx);
+    }
+    pthread_mutex_unlock(&s_sim.mtx);
+    return idle;
+}
+
+// --- esp_wifi / esp_now ---
+
+esp_err_t esp_wifi_get_mac(const wifi_interface_t ifx, uint8_t mac[6]) {
+    (void)ifx;
+    if (!mac) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_sim.mtx);
+    memcpy(mac, s_sim.cfg.own_mac, 6);
+    pthread_mutex_unlock(&s_sim.mtx);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_init(void) {
+    pthread_once(&s_cond_once, cond_init);
+    pthread_mutex_lock(&s_sim.mtx);
+    if (s_sim.running) {
+        pthread_mutex_unlock(&s_sim.mtx);
+        return ESP_OK;
+    }
+
+    memset(s_sim.events, 0, sizeof(s_sim.events));
+    memset(s_sim.peer_used, 0, sizeof(s_sim.peer_used));
+    s_sim.n_events = 0;
+    s_sim.pending_tx = 0;
+    s_sim.channel_free_us = 0;
+    s_sim.stop = false;
+    s_sim.running = pthread_create(&s_sim.thread, NULL, sim_thread, NULL) == 0;
+    const bool running = s_sim.running;
+    pthread_mutex_unlock(&s_sim.mtx);
+    return running ? ESP_OK : ESP_ERR_ESPNOW_INTERNAL;
+}
+
+esp_err_t esp_now_deinit(void) {
+    pthread_mutex_lock(&s_sim.mtx);
+    if (!s_sim.running) {
+        pthread_mutex_unlock(&s_sim.mtx);
+        return ESP_OK;
+    }
+    s_sim.stop = true;
+    pthread_cond_broadcast(&s_sim.cond);
+    pthread_mutex_unlock(&s_sim.mtx);
+    pthread_join(s_sim.thread, NULL);
+
+    pthread_mutex_lock(&s_sim.mtx);
+    s_sim.running = false;
+    s_sim.recv_cb = NULL;
+    s_sim.send_cb = NULL;
+    s_sim.n_events = 0;
+    s_sim.pending_tx = 0;
+    memset(s_sim.events, 0, sizeof(s_sim.events));
+    pthread_mutex_unlock(&s_sim.mtx);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(const esp_now_recv_cb_t cb) {
+    pthread_mutex_lock(&s_sim.mtx);
+    s_sim.recv_cb = cb;
+    pthread_mutex_unlock(&s_sim.mtx);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_unregister_recv_cb(void) { return esp_now_register_recv_cb(NULL); }
+
+esp_err_t esp_now_register_send_cb(const esp_now_send_cb_t cb) {
+    pthread_mutex_lock(&s_sim.mtx);
+    s_sim.send_cb = cb;
+    pthread_mutex_unlock(&s_sim.mtx);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_unregister_send_cb(void) { return esp_now_register_send_cb(NULL); }
+
+// Aufrufer hält mtx
+static int peer_index(const uint8_t* mac) {
+    for (int i = 0; i < ESP_NOW_MAX_TOTAL_PEER_NUM; ++i) {
+        if (s_sim.peer_used[i] && memcmp(s_sim.peers[i].peer_addr, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+    if (!peer) return ESP_ERR_ESPNOW_ARG;
+    pthread_mutex_lock(&s_sim.mtx);
+    esp_err_t err = ESP_OK;
+    int free_idx = -1;
+    int n_encrypted = 0;
+    for (int i = 0; i < ESP_NOW_MAX_TOTAL_PEER_NUM; ++i) {
+        if (!s_sim.peer_used[i]) {
+            if (free_idx < 0) free_idx = i;
+        } else if (s_sim.peers[i].encrypt) {
+            n_encrypted++;
+        }
+    }
+    if (!s_sim.running) err = ESP_ERR_ESPNOW_NOT_INIT;
+    else if (peer_index(peer->peer_addr) >= 0) err = ESP_ERR_ESPNOW_EXIST;
+    else if (free_idx < 0) err = ESP_ERR_ESPNOW_FULL;
+    else if (peer->encrypt && n_encrypted >= ESP_NOW_MAX_ENCRYPT_PEER_NUM) err = ESP_ERR_ESPNOW_FULL;
+    else {
+        s_sim.peers[free_idx] = *peer;
+        s_sim.peer_used[free_idx] = true;
+    }
+    pthread_mutex_unlock(&s_sim.mtx);
+    return err;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t* peer_addr) {
+    if (!peer_addr) return ESP_ERR_ESPNOW_ARG;
+    pthread_mutex_lock(&s_sim.mtx);
+    const int idx = peer_index(peer_addr);
+    if (idx >= 0) s_sim.peer_used[idx] = false;
+    pthread_mutex_unlock(&s_sim.mtx);
+    return idx >= 0 ? ESP_OK : ESP_ERR_ESPNOW_NOT_FOUND;
+}
+
+bool esp_now_is_peer_exist(const uint8_t* peer_addr) {
+    if (!peer_addr) return false;
+    pthread_mutex_lock(&s_sim.mtx);
+    const bool exists = peer_index(peer_addr) >= 0;
+    pthread_mutex_unlock(&s_sim.mtx);
+    return exists;
+}
+
+esp_err_t esp_now_set_pmk(const uint8_t* pmk) {
+    return pmk ? ESP_OK : ESP_ERR_ESPNOW_ARG;
+}
+
+esp_err_t esp_now_send(const uint8_t* peer_addr, const uint8_t* data, const size_t len) {
+    if (!peer_addr || !data || len == 0 || len > ESP_NOW_MAX_DATA_LEN) return ESP_ERR_ESPNOW_ARG;
+
+    pthread_mutex_lock(&s_sim.mtx);
+    if (!s_sim.running) {
+        pthread_mutex_unlock(&s_sim.mtx);
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    }
+    if (peer_index(peer_addr) < 0) {
+        pthread_mutex_unlock(&s_sim.mtx);
+        return ESP_ERR_ESPNOW_NOT_FOUND;
+    }
+    if (s_sim.pending_tx >= s_sim.cfg.tx_buffer_frames) {
+        s_sim.stats.driver_busy++;
+        pthread_mutex_unlock(&s_sim.mtx);
+        return ESP_ERR_ESPNOW_NO_MEM;
+    }
+
+    const espnow_sim_tx_hook_t hook = s_sim.tx_hook;
+    void* hook_ctx = s_sim.tx_hook_ctx;
+
+    // Sendedauer auf dem gemeinsamen Kanal
+    const uint64_t now = now_us();
+    const uint64_t start = s_sim.channel_free_us > now ? s_sim.channel_free_us : now;
+    const uint64_t airtime = s_sim.cfg.phy_rate_kbps
+        ? ((uint64_t)(len + SIM_FRAME_OVERHEAD) * 8u * 1000u) / s_sim.cfg.phy_rate_kbps
+        : 0;
+    const uint64_t tx_end = start + airtime;
+    s_sim.channel_free_us = tx_end;
+
+    const bool bcast = memcmp(peer_addr, s_bcast, 6) == 0;
+    const uint8_t* src = bcast ? s_sim.cfg.bcast_src : peer_addr;
+    const bool lost = rng_chance(s_sim.cfg.loss);
+    s_sim.stats.sent++;
+
+    if (lost) {
+        s_sim.stats.lost++;
+    } else {
+        const int copies = rng_chance(s_sim.cfg.duplicate) ? 2 : 1;
+        if (copies > 1) s_sim.stats.duplicated++;
+        for (int c = 0; c < copies; ++c) {
+            uint64_t due = tx_end + (uint64_t)s_sim.cfg.latency_ms * 1000u;
+            if (s_sim.cfg.jitter_ms) due += (rng_next() % (s_sim.cfg.jitter_ms * 1000u + 1));
+            if (rng_chance(s_sim.cfg.reorder)) {
+                due += (uint64_t)s_sim.cfg.reorder_delay_ms * 1000u;
+                s_sim.stats.reordered++;
+            }
+            if (!event_push(SIM_EV_RX, due, src, data, len, ESP_NOW_SEND_SUCCESS)) s_sim.stats.lost++;
+        }
+    }
+
+    // Unicast wird auf MAC-Ebene quittiert; Broadcast meldet immer Erfolg
+    const esp_now_send_status_t status = (lost && !bcast) ? ESP_NOW_SEND_FAIL : ESP_NOW_SEND_SUCCESS;
+    if (event_push(SIM_EV_TX_DONE, tx_end, peer_addr, NULL, 0, status)) s_sim.pending_tx++;
+    pthread_mutex_unlock(&s_sim.mtx);
+
+    if (hook) hook(peer_addr, data, len, hook_ctx);
+    return ESP_OK;
+}
@@ -0,0 +1,297 @@
+// FreeRTOS-Shim auf pthreads für den nativen Build.
+// Genau genug für die ESPNOW-Schicht: blockierende Semaphoren/Queues mit Timeout,
+// Tasks als Threads und Task-Notifications als Zähler.
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_sem {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct host_queue {
+    pthread_mutex_t mtx;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t* storage;
+};
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* arg;
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    uint32_t notify;
+    bool owned_thread;  // von xTaskCreate gestartet (sonst: lazily für fremde Threads angelegt)
+};
+
+static _Thread_local struct host_task* s_self;
+
+static void cond_init_monotonic(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline_after(const TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+    ts.tv_sec += (time_t)(ms / 1000);
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Wartet auf cond, bis pred() wahr ist oder die Frist abläuft. Aufrufer hält mtx.
+#define WAIT_UNTIL(cond_, mtx_, ticks_, pred_) ({                                  \
+        bool ok_ = true;                                                           \
+        if ((ticks_) == portMAX_DELAY) {                                           \
+            while (!(pred_)) pthread_cond_wait((cond_), (mtx_));                   \
+        } else {                                                                   \
+            const struct timespec dl_ = deadline_after(ticks_);                    \
+            while (!(pred_)) {                                                     \
+                if (pthread_cond_timedwait((cond_), (mtx_), &dl_) == ETIMEDOUT) {  \
+                    ok_ = (pred_);                                                 \
+                    break;                                                         \
+                }                                                                  \
+            }                                                                      \
+        }                                                                          \
+        ok_;                                                                       \
+    })
+
+// --- Semaphoren ---
+
+static SemaphoreHandle_t sem_create(const UBaseType_t max, const UBaseType_t initial) {
+    struct host_sem* s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_init(&s->mtx, NULL);
+    cond_init_monotonic(&s->cond);
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return sem_create(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return sem_create(1, 0); }
+SemaphoreHandle_t xSemaphoreCreateCounting(const UBaseType_t max_count, const UBaseType_t initial_count) {
+    return sem_create(max_count, initial_count);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, const TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&sem->mtx);
+    const bool ok = WAIT_UNTIL(&sem->cond, &sem->mtx, ticks_to_wait, sem->count > 0);
+    if (ok) sem->count--;
+    pthread_mutex_unlock(&sem->mtx);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->mtx);
+    const bool ok = sem->count < sem->max;
+    if (ok) {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->mtx);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->mtx);
+    const UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->mtx);
+    return count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (!sem) return;
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mtx);
+    free(sem);
+}
+
+// --- Queues ---
+
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t item_size) {
+    struct host_queue* q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->storage = calloc(length, item_size);
+    if (!q->storage) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->mtx, NULL);
+    cond_init_monotonic(&q->not_empty);
+    cond_init_monotonic(&q->not_full);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, const TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&q->mtx);
+    const bool ok = WAIT_UNTIL(&q->not_full, &q->mtx, ticks_to_wait, q->count < q->length);
+    if (ok) {
+        const UBaseType_t tail = (q->head + q->count) % q->length;
+        memcpy(q->storage + (size_t)tail * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->mtx);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, const TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&q->mtx);
+    const bool ok = WAIT_UNTIL(&q->not_empty, &q->mtx, ticks_to_wait, q->count > 0);
+    if (ok) {
+        memcpy(item, q->storage + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->mtx);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->mtx);
+    const UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->mtx);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    if (!q) return;
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->mtx);
+    free(q->storage);
+    free(q);
+}
+
+// --- Tasks ---
+
+static struct host_task* task_alloc(void) {
+    struct host_task* t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    pthread_mutex_init(&t->mtx, NULL);
+    cond_init_monotonic(&t->cond);
+    return t;
+}
+
+static void task_free(struct host_task* t) {
+    pthread_cond_destroy(&t->cond);
+    pthread_mutex_destroy(&t->mtx);
+    free(t);
+}
+
+// Threads, die nicht über xTaskCreate entstanden sind (z. B. der Testrunner), bekommen
+// beim ersten Bedarf einen Task-Kontext für Notifications.
+static struct host_task* task_self(void) {
+    if (!s_self) s_self = task_alloc();
+    return s_self;
+}
+
+static void* task_trampoline(void* arg) {
+    struct host_task* t = arg;
+    s_self = t;
+    t->fn(t->arg);
+    // Eine FreeRTOS-Task darf nicht zurückkehren; hier trotzdem sauber aufräumen
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(const TaskFunction_t fn, const char* name, const uint32_t stack_depth, void* arg,
+                       const UBaseType_t priority, TaskHandle_t* handle_out) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    struct host_task* t = task_alloc();
+    if (!t) return pdFAIL;
+    t->fn = fn;
+    t->arg = arg;
+    t->owned_thread = true;
+    if (handle_out) *handle_out = t;
+    if (pthread_create(&t->thread, NULL, task_trampoline, t) != 0) {
+        task_free(t);
+        if (handle_out) *handle_out = NULL;
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Fremde Tasks abzubrechen unterstützt der Shim nicht; die ESPNOW-Schicht beendet ihre Tasks selbst
+    if (task && task != s_self) return;
+    struct host_task* self = s_self;
+    s_self = NULL;
+    if (self) {
+        const bool owned = self->owned_thread;
+        task_free(self);
+        if (owned) pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(const TickType_t ticks) {
+    const uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+    struct timespec ts = {.tv_sec = (time_t)(ms / 1000), .tv_nsec = (long)(ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+}
+
+static struct timespec s_tick_start;
+static pthread_once_t s_tick_once = PTHREAD_ONCE_INIT;
+
+static void tick_start_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &s_tick_start);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    pthread_once(&s_tick_once, tick_start_init);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const int64_t ms = (int64_t)(now.tv_sec - s_tick_start.tv_sec) * 1000 +
+                       (now.tv_nsec - s_tick_start.tv_nsec) / 1000000;
+    return (TickType_t)(ms / portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFAIL;
+    pthread_mutex_lock(&task->mtx);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->mtx);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clear_on_exit, const TickType_t ticks_to_wait) {
+    struct host_task* t = task_self();
+    pthread_mutex_lock(&t->mtx);
+    WAIT_UNTIL(&t->cond, &t->mtx, ticks_to_wait, t->notify > 0);
+    const uint32_t value = t->notify;
+    if (value > 0) t->notify = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&t->mtx);
+    return value;
+}
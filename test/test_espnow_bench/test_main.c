@@ -0,0 +1,134 @@
+// Durchsatz- und Latenzmessung der ESPNOW-Schicht über das simulierte Funkmedium.
+// Kanalmodell: 1 Mbit/s (ESPNOW-Standardrate), 1 ms Laufzeit. Die Zahlen sind nur
+// relativ zueinander aussagekräftig, d. h. zum Vergleich vor/nach einer Änderung.
+// Ausführen: pio test -e native -f test_espnow_bench -v
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "espnow.h"
+#include "espnow_sim.h"
+
+#ifndef BENCH_MESSAGES
+#define BENCH_MESSAGES 20
+#endif
+
+static const uint8_t PEER[6]  = {0x02, 0x00, 0x00, 0x00, 0x00, 0xA1};
+
+static SemaphoreHandle_t s_arrived;
+
+static void on_recv(const uint8_t mac[6], const uint8_t* data, const size_t len, void* user_ctx) {
+    (void)mac;
+    (void)data;
+    (void)len;
+    (void)user_ctx;
+    xSemaphoreGive(s_arrived);
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+typedef esp_err_t (*send_fn_t)(const uint8_t peer_mac[6], const void* data, size_t len);
+
+static void start(const espnow_dispatch_mode_t dispatch, const float loss) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.loss = loss;
+    espnow_sim_configure(&sim);
+    espnow_config_t cfg = ESPNOW_CONFIG_DEFAULT();
+    cfg.recv_cb = on_recv;
+    cfg.dispatch = dispatch;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_init_with_config(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(PEER, NULL, false));
+}
+
+// Latenz: Nachricht senden und auf Zustellung warten (eine Nachricht unterwegs).
+// Durchsatz: alle Nachrichten direkt hintereinander, Zeit bis zur letzten Zustellung.
+static void bench(const char* label, const send_fn_t send, const espnow_dispatch_mode_t dispatch,
+                  const float loss, const size_t len) {
+    start(dispatch, loss);
+    static uint8_t msg[ESPNOW_MAX_MESSAGE_SIZE];
+    memset(msg, 0xA5, len);
+    while (xSemaphoreTake(s_arrived, 0) == pdTRUE) {}
+
+    uint64_t lat[BENCH_MESSAGES];
+    uint32_t delivered = 0;
+    for (int i = 0; i < BENCH_MESSAGES; ++i) {
+        const uint64_t t0 = now_us();
+        send(PEER, msg, len);
+        if (xSemaphoreTake(s_arrived, pdMS_TO_TICKS(2000)) == pdTRUE) delivered++;
+        lat[i] = now_us() - t0;
+    }
+    espnow_sim_flush(2000);
+    while (xSemaphoreTake(s_arrived, 0) == pdTRUE) {}
+    qsort(lat, BENCH_MESSAGES, sizeof(lat[0]), cmp_u64);
+
+    const uint64_t t0 = now_us();
+    for (int i = 0; i < BENCH_MESSAGES; ++i) send(PEER, msg, len);
+    uint32_t burst_delivered = 0;
+    while (burst_delivered < BENCH_MESSAGES && xSemaphoreTake(s_arrived, pdMS_TO_TICKS(2000)) == pdTRUE) {
+        burst_delivered++;
+    }
+    const uint64_t elapsed = now_us() - t0;
+    const double kib_s = (double)len * burst_delivered / 1024.0 / ((double)elapsed / 1e6);
+
+    espnow_sim_stats_t stats;
+    espnow_sim_get_stats(&stats);
+    espnow_sim_flush(2000);
+    espnow_deinit();
+
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%-9s %-6s loss=%2.0f%% len=%5zu  p50=%6.2f ms  p99=%6.2f ms  thr=%7.1f KiB/s  "
+             "ok=%" PRIu32 "/%d+%" PRIu32 "/%d  busy=%" PRIu32,
+             label, dispatch == ESPNOW_DISPATCH_TASK ? "task" : "inline", loss * 100.0f, len,
+             lat[BENCH_MESSAGES / 2] / 1000.0, lat[(BENCH_MESSAGES * 99) / 100] / 1000.0, kib_s,
+             delivered, BENCH_MESSAGES, burst_delivered, BENCH_MESSAGES, stats.driver_busy);
+    TEST_MESSAGE(line);
+
+    // Ohne Verlust muss alles ankommen; sonst ist die Messung wertlos
+    if (loss == 0.0f) TEST_ASSERT_EQUAL(BENCH_MESSAGES, delivered);
+}
+
+static const size_t SIZES[] = {16, 249, 1000, 4000, ESPNOW_MAX_MESSAGE_SIZE};
+
+static void test_bench_send(void) {
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); ++i) {
+        bench("send", espnow_send, ESPNOW_DISPATCH_INLINE, 0.0f, SIZES[i]);
+        bench("send", espnow_send, ESPNOW_DISPATCH_TASK, 0.0f, SIZES[i]);
+    }
+}
+
+static void test_bench_reliable(void) {
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); ++i) {
+        bench("reliable", espnow_send_reliable, ESPNOW_DISPATCH_TASK, 0.0f, SIZES[i]);
+        bench("reliable", espnow_send_reliable, ESPNOW_DISPATCH_TASK, 0.05f, SIZES[i]);
+    }
+}
+
+void setUp(void) {
+    if (!s_arrived) s_arrived = xSemaphoreCreateCounting(4 * BENCH_MESSAGES, 0);
+}
+
+void tearDown(void) {}
+
+int main(void) {
+    esp_log_level_set("*", ESP_LOG_NONE);
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_send);
+    RUN_TEST(test_bench_reliable);
+    return UNITY_END();
+}
@@ -0,0 +1,240 @@
+// Fuzz-Tests für den Empfangspfad der ESPNOW-Schicht.
+// Rohframes (zufällig oder aus echten Frames mutiert) werden direkt ins simulierte
+// Medium gespeist; die Schicht darf weder abstürzen noch falsche Nachrichten zustellen.
+// Am wirksamsten mit Sanitizern (siehe [env:native] in platformio.ini).
+// Ausführen: pio test -e native -f test_espnow_fuzz
+#include <string.h>
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "espnow.h"
+#include "espnow_sim.h"
+
+#ifndef FUZZ_ITERATIONS
+#define FUZZ_ITERATIONS 20000
+#endif
+
+#define CAPTURE_MAX 64
+
+static const uint8_t PEER[6]  = {0x02, 0x00, 0x00, 0x00, 0x00, 0xA1};
+static const uint8_t BCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static uint32_t s_rng = 0x12345678u;
+
+static uint32_t rnd(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+// Nutzdaten tragen Länge und Prüfsumme, damit jede Zustellung auf Unversehrtheit geprüft werden kann
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t len;
+    uint32_t checksum;
+} probe_hdr_t;
+
+#define PROBE_MAGIC 0x50524F42u
+
+static uint32_t checksum(const uint8_t* data, const size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static size_t build_probe(uint8_t* buf, const size_t len) {
+    probe_hdr_t hdr = {.magic = PROBE_MAGIC, .len = (uint32_t)len};
+    for (size_t i = sizeof(hdr); i < len; ++i) buf[i] = (uint8_t)rnd();
+    hdr.checksum = checksum(buf + sizeof(hdr), len - sizeof(hdr));
+    memcpy(buf, &hdr, sizeof(hdr));
+    return len;
+}
+
+static struct {
+    SemaphoreHandle_t lock;
+    uint32_t delivered;
+    uint32_t valid_probes;
+    uint32_t corrupt_probes;   // Magic stimmt, Inhalt nicht
+    uint32_t oversized;
+} s_rx;
+
+static void on_recv(const uint8_t mac[6], const uint8_t* data, const size_t len, void* user_ctx) {
+    (void)mac;
+    (void)user_ctx;
+    xSemaphoreTake(s_rx.lock, portMAX_DELAY);
+    s_rx.delivered++;
+    if (len > ESPNOW_MAX_MESSAGE_SIZE) s_rx.oversized++;
+    probe_hdr_t hdr;
+    if (len >= sizeof(hdr)) {
+        memcpy(&hdr, data, sizeof(hdr));
+        if (hdr.magic == PROBE_MAGIC) {
+            const bool ok = hdr.len == len && hdr.checksum == checksum(data + sizeof(hdr), len - sizeof(hdr));
+            if (ok) s_rx.valid_probes++;
+            else s_rx.corrupt_probes++;
+        }
+    }
+    xSemaphoreGive(s_rx.lock);
+}
+
+// Mitgeschnittene echte Frames als Ausgangsmaterial für Mutationen
+static struct {
+    uint8_t data[CAPTURE_MAX][250];
+    size_t len[CAPTURE_MAX];
+    size_t count;
+} s_cap;
+
+static void on_tx(const uint8_t peer_mac[6], const uint8_t* data, const size_t len, void* user_ctx) {
+    (void)peer_mac;
+    (void)user_ctx;
+    if (s_cap.count >= CAPTURE_MAX) return;
+    memcpy(s_cap.data[s_cap.count], data, len);
+    s_cap.len[s_cap.count] = len;
+    s_cap.count++;
+}
+
+static void start(const espnow_dispatch_mode_t dispatch, const espnow_sim_config_t* sim) {
+    espnow_sim_configure(sim);
+    espnow_config_t cfg = ESPNOW_CONFIG_DEFAULT();
+    cfg.recv_cb = on_recv;
+    cfg.dispatch = dispatch;
+    cfg.reasm_timeout_ms = 50;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_init_with_config(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(BCAST, NULL, false));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(PEER, NULL, false));
+}
+
+// Nach dem Fuzzing muss die Schicht noch normal funktionieren
+static void assert_still_delivers(void) {
+    espnow_sim_flush(2000);
+    vTaskDelay(pdMS_TO_TICKS(60)); // Reassembly-Timeout verstreichen lassen
+    xSemaphoreTake(s_rx.lock, portMAX_DELAY);
+    const uint32_t before = s_rx.valid_probes;
+    xSemaphoreGive(s_rx.lock);
+
+    static uint8_t msg[3000];
+    build_probe(msg, sizeof(msg));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(espnow_sim_flush(2000));
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    xSemaphoreTake(s_rx.lock, portMAX_DELAY);
+    const uint32_t after = s_rx.valid_probes;
+    xSemaphoreGive(s_rx.lock);
+    TEST_ASSERT_EQUAL(before + 1, after);
+}
+
+void setUp(void) {
+    if (!s_rx.lock) s_rx.lock = xSemaphoreCreateMutex();
+    s_rx.delivered = 0;
+    s_rx.valid_probes = 0;
+    s_rx.corrupt_probes = 0;
+    s_rx.oversized = 0;
+    s_cap.count = 0;
+    espnow_sim_set_tx_hook(NULL, NULL);
+}
+
+void tearDown(void) {
+    espnow_sim_set_tx_hook(NULL, NULL);
+    espnow_sim_flush(2000);
+    espnow_deinit();
+}
+
+static void test_random_frames(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    uint8_t frame[250];
+    uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+    for (int i = 0; i < FUZZ_ITERATIONS; ++i) {
+        const size_t len = 1 + rnd() % sizeof(frame);
+        for (size_t k = 0; k < len; ++k) frame[k] = (uint8_t)rnd();
+        // Typ-Byte meist auf bekannte Frame-Typen lenken, sonst endet alles im default-Zweig
+        if (rnd() % 4 != 0) frame[0] = (uint8_t)(1 + rnd() % 4);
+        src[5] = (uint8_t)(rnd() % 8);
+        espnow_sim_inject(src, frame, len);
+        if (i % 256 == 0) espnow_sim_flush(1000);
+    }
+    assert_still_delivers();
+    TEST_ASSERT_EQUAL(0, s_rx.oversized);
+}
+
+static void test_mutated_frames(const espnow_dispatch_mode_t dispatch) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(dispatch, &sim);
+
+    // Echte Frames mitschneiden: einzelne, fragmentierte und zuverlässige Nachrichten
+    espnow_sim_set_tx_hook(on_tx, NULL);
+    static uint8_t msg[2500];
+    espnow_send(PEER, msg, build_probe(msg, 100));
+    espnow_send(PEER, msg, build_probe(msg, sizeof(msg)));
+    espnow_send_reliable(PEER, msg, build_probe(msg, 1200));
+    espnow_sim_set_tx_hook(NULL, NULL);
+    TEST_ASSERT_TRUE(espnow_sim_flush(2000));
+    TEST_ASSERT_GREATER_THAN(3, s_cap.count);
+
+    uint8_t frame[250];
+    for (int i = 0; i < FUZZ_ITERATIONS; ++i) {
+        const size_t pick = rnd() % s_cap.count;
+        size_t len = s_cap.len[pick];
+        memcpy(frame, s_cap.data[pick], len);
+        const int flips = 1 + (int)(rnd() % 4);
+        for (int f = 0; f < flips; ++f) {
+            // Header-Bytes bevorzugt mutieren, dort steckt die Logik
+            const size_t pos = (rnd() % 2) ? rnd() % (len < 16 ? len : 16) : rnd() % len;
+            frame[pos] ^= (uint8_t)(1u << (rnd() % 8));
+        }
+        if (rnd() % 8 == 0) len = 1 + rnd() % len; // abgeschnittene Frames
+        espnow_sim_inject(PEER, frame, len);
+        if (i % 256 == 0) espnow_sim_flush(1000);
+    }
+    assert_still_delivers();
+
+    TEST_ASSERT_EQUAL(0, s_rx.oversized);
+    // Bitfehler in Nutzdaten kann die Schicht nicht erkennen (kein CRC über die Nachricht);
+    // geprüft wird nur, dass nie mehr Daten zugestellt werden als angekommen sind.
+}
+
+static void test_mutated_frames_inline(void) { test_mutated_frames(ESPNOW_DISPATCH_INLINE); }
+static void test_mutated_frames_task(void) { test_mutated_frames(ESPNOW_DISPATCH_TASK); }
+
+static void test_impaired_channel_never_corrupts(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.seed = 99;
+    start(ESPNOW_DISPATCH_TASK, &sim);
+
+    static uint8_t msg[ESPNOW_MAX_MESSAGE_SIZE];
+    for (int round = 0; round < 40; ++round) {
+        sim.loss = (float)(rnd() % 30) / 100.0f;
+        sim.duplicate = (float)(rnd() % 30) / 100.0f;
+        sim.reorder = (float)(rnd() % 50) / 100.0f;
+        sim.jitter_ms = rnd() % 4;
+        sim.seed = rnd();
+        espnow_sim_configure(&sim);
+        for (int m = 0; m < 5; ++m) {
+            const size_t len = sizeof(probe_hdr_t) + rnd() % (sizeof(msg) - sizeof(probe_hdr_t));
+            espnow_send(PEER, msg, build_probe(msg, len));
+        }
+    }
+    TEST_ASSERT_TRUE(espnow_sim_flush(5000));
+
+    // Ohne Bitfehler im Kanal muss jede zugestellte Nachricht exakt stimmen
+    TEST_ASSERT_EQUAL(0, s_rx.corrupt_probes);
+    TEST_ASSERT_GREATER_THAN(0, s_rx.valid_probes);
+}
+
+int main(void) {
+    esp_log_level_set("*", ESP_LOG_NONE);
+    UNITY_BEGIN();
+    RUN_TEST(test_random_frames);
+    RUN_TEST(test_mutated_frames_inline);
+    RUN_TEST(test_mutated_frames_task);
+    RUN_TEST(test_impaired_channel_never_corrupts);
+    return UNITY_END();
+}
@@ -0,0 +1,451 @@
+// ESPNOW-Schicht gegen das simulierte Funkmedium (Loopback, siehe test/host/include/espnow_sim.h).
+// Ausführen: pio test -e native -f test_espnow_sim
+#include <string.h>
+#include <unity.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "espnow.h"
+#include "espnow_sim.h"
+
+static const uint8_t PEER_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xA1};
+static const uint8_t PEER_B[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xA2};
+static const uint8_t BCAST[6]  = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static struct {
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t arrived;     // ein Give je zugestellter Nachricht
+    uint32_t count;
+    uint32_t from_b;
+    size_t len;
+    uint8_t mac[6];
+    uint8_t data[ESPNOW_MAX_MESSAGE_SIZE];
+} s_rx;
+
+static void on_recv(const uint8_t mac[6], const uint8_t* data, const size_t len, void* user_ctx) {
+    (void)user_ctx;
+    xSemaphoreTake(s_rx.lock, portMAX_DELAY);
+    s_rx.count++;
+    if (memcmp(mac, PEER_B, 6) == 0) s_rx.from_b++;
+    memcpy(s_rx.mac, mac, 6);
+    s_rx.len = len;
+    memcpy(s_rx.data, data, len <= sizeof(s_rx.data) ? len : sizeof(s_rx.data));
+    xSemaphoreGive(s_rx.lock);
+    xSemaphoreGive(s_rx.arrived);
+}
+
+static uint32_t rx_count(void) {
+    xSemaphoreTake(s_rx.lock, portMAX_DELAY);
+    const uint32_t n = s_rx.count;
+    xSemaphoreGive(s_rx.lock);
+    return n;
+}
+
+static bool wait_rx(const uint32_t timeout_ms) {
+    return xSemaphoreTake(s_rx.arrived, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+static void fill_pattern(uint8_t* buf, const size_t len, const uint8_t seed) {
+    for (size_t i = 0; i < len; ++i) buf[i] = (uint8_t)(seed + i * 31u + (i >> 8));
+}
+
+static const espnow_link_stats_t* find_link(const espnow_stats_t* st, const uint8_t mac[6]) {
+    for (size_t i = 0; i < st->n_peers; ++i) {
+        if (memcmp(st->peers[i].mac, mac, 6) == 0) return &st->peers[i].link;
+    }
+    return NULL;
+}
+
+static void start(const espnow_dispatch_mode_t dispatch, const espnow_sim_config_t* sim) {
+    espnow_sim_configure(sim);
+    espnow_config_t cfg = ESPNOW_CONFIG_DEFAULT();
+    cfg.recv_cb = on_recv;
+    cfg.dispatch = dispatch;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_init_with_config(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(BCAST, NULL, false));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(PEER_A, NULL, false));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(PEER_B, NULL, false));
+}
+
+void setUp(void) {
+    if (!s_rx.lock) {
+        s_rx.lock = xSemaphoreCreateMutex();
+        s_rx.arrived = xSemaphoreCreateCounting(1024, 0);
+    }
+    while (xSemaphoreTake(s_rx.arrived, 0) == pdTRUE) {}
+    s_rx.count = 0;
+    s_rx.from_b = 0;
+    s_rx.len = 0;
+}
+
+void tearDown(void) {
+    espnow_sim_flush(1000);
+    espnow_deinit();
+}
+
+static void test_single_frame_roundtrip(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    uint8_t msg[32];
+    fill_pattern(msg, sizeof(msg), 1);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(500));
+    TEST_ASSERT_EQUAL(sizeof(msg), s_rx.len);
+    TEST_ASSERT_EQUAL_MEMORY(PEER_A, s_rx.mac, 6);
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_fragmented_roundtrip(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    static uint8_t msg[5000];
+    fill_pattern(msg, sizeof(msg), 2);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(2000));
+    TEST_ASSERT_EQUAL(sizeof(msg), s_rx.len);
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_max_message_task_dispatch(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_TASK, &sim);
+
+    static uint8_t msg[ESPNOW_MAX_MESSAGE_SIZE];
+    fill_pattern(msg, sizeof(msg), 3);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(3000));
+    TEST_ASSERT_EQUAL(sizeof(msg), s_rx.len);
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_oversized_message_rejected(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    static uint8_t msg[ESPNOW_MAX_MESSAGE_SIZE + 1];
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, espnow_send(PEER_A, msg, sizeof(msg)));
+}
+
+static void test_reordered_fragments_reassemble(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.reorder = 0.4f;
+    sim.jitter_ms = 3;
+    sim.seed = 7;
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    static uint8_t msg[3000];
+    fill_pattern(msg, sizeof(msg), 4);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(2000));
+    TEST_ASSERT_EQUAL(sizeof(msg), s_rx.len);
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+
+    espnow_sim_stats_t stats;
+    espnow_sim_get_stats(&stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.reordered);
+}
+
+static void test_duplicated_fragments_deliver_once(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.duplicate = 1.0f;
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    static uint8_t msg[1200];
+    fill_pattern(msg, sizeof(msg), 5);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_TRUE(espnow_sim_flush(1000));
+    TEST_ASSERT_EQUAL(1, rx_count());
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_total_loss_delivers_nothing(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.loss = 1.0f;
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    static uint8_t msg[600];
+    // Ohne Quittierung meldet espnow_send nur die Übergabe an den Treiber
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(espnow_sim_flush(1000));
+    TEST_ASSERT_EQUAL(0, rx_count());
+}
+
+static void test_partial_messages_do_not_block_reassembly(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.loss = 0.5f;
+    sim.seed = 11;
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    // Viele lückenhafte Nachrichten belegen Reassembly-Slots ...
+    static uint8_t msg[2000];
+    for (int i = 0; i < 4 * ESPNOW_MAX_INFLIGHT_MESSAGES; ++i) {
+        fill_pattern(msg, sizeof(msg), (uint8_t)i);
+        espnow_send(PEER_A, msg, sizeof(msg));
+    }
+    TEST_ASSERT_TRUE(espnow_sim_flush(2000));
+
+    // ... eine neue Nachricht muss trotzdem durchkommen (LRU-Verdrängung)
+    sim.loss = 0.0f;
+    espnow_sim_configure(&sim);
+    setUp();
+    fill_pattern(msg, sizeof(msg), 0xEE);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(2000));
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_reliable_recovers_from_loss(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.loss = 0.2f;
+    sim.seed = 3;
+    start(ESPNOW_DISPATCH_TASK, &sim);
+
+    static uint8_t msg[4000];
+    fill_pattern(msg, sizeof(msg), 6);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send_reliable(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_TRUE(espnow_sim_flush(2000));
+    TEST_ASSERT_EQUAL(1, rx_count());
+    TEST_ASSERT_EQUAL(sizeof(msg), s_rx.len);
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+
+    // Zuverlässige Nachrichten zählen nur im Histogramm bis zur Quittung
+    static espnow_stats_t st;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_get_stats(&st));
+    const espnow_link_stats_t* a = find_link(&st, PEER_A);
+    TEST_ASSERT_NOT_NULL(a);
+    uint32_t sent = 0, acked = 0;
+    for (size_t i = 0; i < ESPNOW_LATENCY_BUCKETS; ++i) {
+        sent += a->send_latency_hist[i];
+        acked += a->ack_latency_hist[i];
+    }
+    TEST_ASSERT_EQUAL(0, sent);
+    TEST_ASSERT_EQUAL(1, acked);
+}
+
+// Mitschnitt gesendeter Frames, um sie nach einem Neustart erneut zuzustellen
+static struct {
+    SemaphoreHandle_t lock;
+    size_t n;
+    size_t len[64];
+    uint8_t frame[64][250];
+} s_cap;
+
+static void capture_tx(const uint8_t peer_mac[6], const uint8_t* data, const size_t len, void* user_ctx) {
+    (void)user_ctx;
+    if (memcmp(peer_mac, PEER_A, 6) != 0 || len > sizeof(s_cap.frame[0])) return;
+    xSemaphoreTake(s_cap.lock, portMAX_DELAY);
+    if (s_cap.n < 64) {
+        memcpy(s_cap.frame[s_cap.n], data, len);
+        s_cap.len[s_cap.n++] = len;
+    }
+    xSemaphoreGive(s_cap.lock);
+}
+
+static void test_reliable_after_sender_restart(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    if (!s_cap.lock) s_cap.lock = xSemaphoreCreateMutex();
+    s_cap.n = 0;
+
+    // Erste Sitzung: einige zuverlässige Nachrichten, Frames mitschneiden
+    start(ESPNOW_DISPATCH_TASK, &sim);
+    espnow_sim_set_tx_hook(capture_tx, NULL);
+    static uint8_t msg[300];
+    for (uint8_t i = 0; i < 3; ++i) {
+        fill_pattern(msg, sizeof(msg), i);
+        TEST_ASSERT_EQUAL(ESP_OK, espnow_send_reliable(PEER_A, msg, sizeof(msg)));
+        TEST_ASSERT_TRUE(wait_rx(1000));
+    }
+    TEST_ASSERT_TRUE(espnow_sim_flush(1000));
+    espnow_sim_set_tx_hook(NULL, NULL);
+    espnow_deinit();
+
+    // Neustart des Senders. Der Empfänger soll die alten IDs noch kennen: Mitschnitt erneut
+    // zustellen, damit sie wieder in seinem rel_done-Cache stehen
+    start(ESPNOW_DISPATCH_TASK, &sim);
+    for (size_t i = 0; i < s_cap.n; ++i) espnow_sim_inject(PEER_A, s_cap.frame[i], s_cap.len[i]);
+    TEST_ASSERT_TRUE(espnow_sim_flush(1000));
+    while (wait_rx(50)) {}
+    const uint32_t before = rx_count();
+
+    fill_pattern(msg, sizeof(msg), 42);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send_reliable(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_EQUAL(before + 1, rx_count());
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_reliable_rejects_broadcast(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    uint8_t msg[8] = {0};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, espnow_send_reliable(BCAST, msg, sizeof(msg)));
+}
+
+static void test_multi_send_reaches_every_peer(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    const uint8_t targets[2][6] = {
+        {0x02, 0x00, 0x00, 0x00, 0x00, 0xA1},
+        {0x02, 0x00, 0x00, 0x00, 0x00, 0xA2},
+    };
+    static uint8_t msg[700];
+    fill_pattern(msg, sizeof(msg), 8);
+    esp_err_t status[2];
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send_multi(targets, 2, msg, sizeof(msg), status));
+    TEST_ASSERT_EQUAL(ESP_OK, status[0]);
+    TEST_ASSERT_EQUAL(ESP_OK, status[1]);
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_EQUAL(2, rx_count());
+    TEST_ASSERT_EQUAL(1, s_rx.from_b);
+}
+
+static volatile esp_err_t s_async_result = ESP_FAIL;
+static SemaphoreHandle_t s_async_done;
+
+static void on_async_done(const uint8_t peer_mac[6], const esp_err_t result, void* user_ctx) {
+    (void)peer_mac;
+    (void)user_ctx;
+    s_async_result = result;
+    xSemaphoreGive(s_async_done);
+}
+
+static void test_async_send_reports_completion(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+    if (!s_async_done) s_async_done = xSemaphoreCreateBinary();
+
+    uint8_t msg[100];
+    fill_pattern(msg, sizeof(msg), 9);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send_async(PEER_A, msg, sizeof(msg), on_async_done, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(s_async_done, pdMS_TO_TICKS(1000)) == pdTRUE);
+    TEST_ASSERT_EQUAL(ESP_OK, s_async_result);
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_EQUAL_MEMORY(msg, s_rx.data, sizeof(msg));
+}
+
+static void test_peer_registry_tracks_link_state(void) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.rssi = -55;
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    uint8_t msg[16] = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_B, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(500));
+
+    espnow_peer_info_t info;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_get_peer(PEER_B, &info));
+    TEST_ASSERT_EQUAL(-55, info.rssi);
+    TEST_ASSERT_EQUAL(100, info.link_quality);
+    TEST_ASSERT_TRUE(espnow_peer_known(PEER_A));
+    TEST_ASSERT_FALSE(espnow_peer_known(BCAST));
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_remove_peer(PEER_A));
+    TEST_ASSERT_FALSE(espnow_peer_known(PEER_A));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, espnow_get_peer(PEER_A, &info));
+}
+
+static void test_peer_registry_evicts_least_recently_seen(void) {
+    const espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    start(ESPNOW_DISPATCH_INLINE, &sim);
+
+    // PEER_A und PEER_B sind bereits registriert; Register bis zur Grenze füllen
+    uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x00};
+    for (int i = 2; i < ESPNOW_MAX_PEERS; ++i) {
+        mac[5] = (uint8_t)i;
+        vTaskDelay(pdMS_TO_TICKS(2));
+        TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(mac, NULL, false));
+    }
+
+    // PEER_A frisch halten, damit PEER_B der älteste ist
+    uint8_t msg[4] = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(500));
+
+    mac[4] = 0x02;
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_add_peer(mac, NULL, false));
+    TEST_ASSERT_TRUE(espnow_peer_known(mac));
+    TEST_ASSERT_TRUE(espnow_peer_known(PEER_A));
+    TEST_ASSERT_FALSE(espnow_peer_known(PEER_B));
+
+    espnow_peer_info_t peers[ESPNOW_MAX_PEERS + 1];
+    TEST_ASSERT_EQUAL(ESPNOW_MAX_PEERS, espnow_get_peers(peers, ESPNOW_MAX_PEERS + 1));
+}
+
+static void check_link_stats(const espnow_dispatch_mode_t dispatch) {
+    espnow_sim_config_t sim = ESPNOW_SIM_CONFIG_DEFAULT();
+    sim.rssi = -60;
+    sim.duplicate = 1.0f;
+    start(dispatch, &sim);
+
+    static uint8_t msg[1000];
+    fill_pattern(msg, sizeof(msg), 9);
+    TEST_ASSERT_EQUAL(ESP_OK, espnow_send(PEER_A, msg, sizeof(msg)));
+    TEST_ASSERT_TRUE(wait_rx(1000));
+    TEST_ASSERT_TRUE(espnow_sim_flush(1000));
+
+    // Mit Worker-Task bucht diese Sendestatus und Empfangsmetadaten nach; kurz nachlaufen lassen
+    static espnow_stats_t st;
+    const espnow_link_stats_t* a = NULL;
+    for (int i = 0; i < 100; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, espnow_get_stats(&st));
+        a = find_link(&st, PEER_A);
+        if (a && a->tx_frames == 5 && a->rx_frames == 10) break;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    TEST_ASSERT_EQUAL(2, st.n_peers);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL(5, a->tx_frames);
+    TEST_ASSERT_EQUAL(0, a->tx_failed);
+    TEST_ASSERT_EQUAL(10, a->rx_frames);
+    TEST_ASSERT_EQUAL(1, a->rx_messages);
+    // Die Kopie des letzten Fragments trifft erst nach der Zustellung ein und öffnet einen neuen Slot
+    TEST_ASSERT_EQUAL(4, a->dup_frags);
+    TEST_ASSERT_EQUAL(-60, a->rssi_avg);
+    uint32_t sent = 0, acked = 0;
+    for (size_t i = 0; i < ESPNOW_LATENCY_BUCKETS; ++i) {
+        sent += a->send_latency_hist[i];
+        acked += a->ack_latency_hist[i];
+    }
+    TEST_ASSERT_EQUAL(1, sent);
+    TEST_ASSERT_EQUAL(0, acked);
+    TEST_ASSERT_EQUAL(0, find_link(&st, PEER_B)->tx_frames);
+}
+
+static void test_link_stats_count_traffic(void) {
+    check_link_stats(ESPNOW_DISPATCH_INLINE);
+}
+
+static void test_link_stats_count_traffic_task(void) {
+    check_link_stats(ESPNOW_DISPATCH_TASK);
+}
+
+int main(void) {
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    UNITY_BEGIN();
+    RUN_TEST(test_single_frame_roundtrip);
+    RUN_TEST(test_fragmented_roundtrip);
+    RUN_TEST(test_max_message_task_dispatch);
+    RUN_TEST(test_oversized_message_rejected);
+    RUN_TEST(test_reordered_fragments_reassemble);
+    RUN_TEST(test_duplicated_fragments_deliver_once);
+    RUN_TEST(test_total_loss_delivers_nothing);
+    RUN_TEST(test_partial_messages_do_not_block_reassembly);
+    RUN_TEST(test_reliable_recovers_from_loss);
+    RUN_TEST(test_reliable_after_sender_restart);
+    RUN_TEST(test_reliable_rejects_broadcast);
+    RUN_TEST(test_multi_send_reaches_every_peer);
+    RUN_TEST(test_async_send_reports_completion);
+    RUN_TEST(test_peer_registry_tracks_link_state);
+    RUN_TEST(test_peer_registry_evicts_least_recently_seen);
+    RUN_TEST(test_link_stats_count_traffic);
+    RUN_TEST(test_link_stats_count_traffic_task);
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// Festkomma-Normalisierung der Joystick-Achsen gegen die frühere Gleitkomma-Variante.
+// Prüft Ergebnisgleichheit über alle Rohwerte und misst die Laufzeit je Aufruf.
+// Auf dem Host rechnet die FPU; auf dem ESP32-C6 (ohne FPU) läuft die Gleitkomma-
+// Variante über Soft-Float, der Abstand ist dort deutlich größer.
+// Ausführen: pio test -e native -f test_joystick_norm -v
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+#include "joystick_norm.h"
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 200
+#endif
+
+// Referenz: Implementierung vor der Umstellung auf Festkomma
+static int8_t normalize_float(const int raw, const axis_calib_t* c) {
+    if (!c || !c->inited) return 0;
+    const int pos_span = (c->max > c->mid) ? (c->max - c->mid) : 1;
+    const int neg_span = (c->mid > c->min) ? (c->mid - c->min) : 1;
+    float pct;
+    if (raw >= c->mid) {
+        pct = ((float)(raw - c->mid) / (float)pos_span) * 100.0f;
+    } else {
+        pct = -((float)(c->mid - raw) / (float)neg_span) * 100.0f;
+    }
+    if (pct > -JS_DEADZONE_PC && pct < JS_DEADZONE_PC) pct = 0.0f;
+    if (pct > 100.0f) pct = 100.0f;
+    if (pct < -100.0f) pct = -100.0f;
+    return (int8_t)pct;
+}
+
+// Exakte Ganzzahlrechnung als Sollwert
+static int8_t normalize_exact(const int raw, const axis_calib_t* c) {
+    const int d = raw - c->mid;
+    int span = (d >= 0) ? c->max - c->mid : c->mid - c->min;
+    if (span < 1) span = 1;
+    int pct = d * 100 / span;
+    if (abs(pct) < JS_DEADZONE_PC) pct = 0;
+    if (pct > 100) pct = 100;
+    if (pct < -100) pct = -100;
+    return (int8_t)pct;
+}
+
+static axis_calib_t make_cal(const int min, const int mid, const int max) {
+    axis_calib_t c = {.min = min, .mid = mid, .max = max};
+    axis_calib_update(&c);
+    return c;
+}
+
+static const int CALS[][3] = {
+    {0, 2048, 4095}, {300, 1900, 3800}, {1000, 1001, 1002}, {0, 0, 4095},
+    {0, 4095, 4095}, {1800, 2000, 2200}, {17, 2111, 4003}, {2048, 2048, 2048},
+};
+
+static void test_fixed_matches_exact(void) {
+    for (size_t k = 0; k < sizeof(CALS) / sizeof(CALS[0]); ++k) {
+        const axis_calib_t c = make_cal(CALS[k][0], CALS[k][1], CALS[k][2]);
+        for (int raw = 0; raw <= JS_RAW_MAX; ++raw) {
+            TEST_ASSERT_EQUAL_INT(normalize_exact(raw, &c), normalize_axis_with_cal(raw, &c));
+        }
+    }
+}
+
+static void test_fixed_matches_float(void) {
+    // Gleitkomma rundet an ganzzahligen Grenzen gelegentlich knapp darunter: höchstens 1 % Abweichung
+    uint32_t diffs = 0;
+    for (size_t k = 0; k < sizeof(CALS) / sizeof(CALS[0]); ++k) {
+        const axis_calib_t c = make_cal(CALS[k][0], CALS[k][1], CALS[k][2]);
+        for (int raw = 0; raw <= JS_RAW_MAX; ++raw) {
+            const int f = normalize_float(raw, &c);
+            const int q = normalize_axis_with_cal(raw, &c);
+            TEST_ASSERT_INT_WITHIN(1, f, q);
+            if (f != q) diffs++;
+        }
+    }
+    char line[64];
+    snprintf(line, sizeof(line), "abweichend von float: %u", diffs);
+    TEST_MESSAGE(line);
+}
+
+static void test_adapt_updates_scale(void) {
+    axis_calib_t c = make_cal(1000, 2000, 3000);
+    TEST_ASSERT_EQUAL_INT(100, normalize_axis_with_cal(3000, &c));
+    adapt_axis_calib(&c, 4000);
+    TEST_ASSERT_EQUAL_INT(4000, c.max);
+    TEST_ASSERT_EQUAL_INT(50, normalize_axis_with_cal(3000, &c));
+    adapt_axis_calib(&c, 0);
+    TEST_ASSERT_EQUAL_INT(-50, normalize_axis_with_cal(1000, &c));
+}
+
+static void test_uncalibrated_returns_zero(void) {
+    const axis_calib_t c = {.min = 0, .mid = 2048, .max = 4095};
+    TEST_ASSERT_EQUAL_INT(0, normalize_axis_with_cal(4095, &c));
+    TEST_ASSERT_EQUAL_INT(0, normalize_axis_with_cal(4095, NULL));
+}
+
+static void test_pct_cal_without_calib(void) {
+    TEST_ASSERT_EQUAL_INT(0, normalize_axis_to_pct_cal(2100, 2048));
+    TEST_ASSERT_EQUAL_INT(100, normalize_axis_to_pct_cal(4095, 2048));
+    TEST_ASSERT_EQUAL_INT(-100, normalize_axis_to_pct_cal(0, 2048));
+    TEST_ASSERT_EQUAL_INT(-50, normalize_axis_to_pct_cal(1024, 2048));
+    TEST_ASSERT_EQUAL_INT(0, normalize_axis_to_pct_cal(4095, 4095));
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static volatile int s_sink;
+
+static double bench(int8_t (*fn)(int, const axis_calib_t*), const axis_calib_t* c) {
+    const double t0 = now_ns();
+    int acc = 0;
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (int raw = 0; raw <= JS_RAW_MAX; ++raw) acc += fn(raw, c);
+    }
+    s_sink = acc;
+    return (now_ns() - t0) / ((double)BENCH_ROUNDS * (JS_RAW_MAX + 1));
+}
+
+static void test_bench_fixed_vs_float(void) {
+    const axis_calib_t c = make_cal(300, 1900, 3800);
+    bench(normalize_float, &c); // Aufwärmen
+    const double t_float = bench(normalize_float, &c);
+    const double t_fixed = bench(normalize_axis_with_cal, &c);
+    char line[128];
+    snprintf(line, sizeof(line), "float=%.2f ns/Aufruf  fixed=%.2f ns/Aufruf  Faktor=%.2f",
+             t_float, t_fixed, t_float / t_fixed);
+    TEST_MESSAGE(line);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_matches_exact);
+    RUN_TEST(test_fixed_matches_float);
+    RUN_TEST(test_adapt_updates_scale);
+    RUN_TEST(test_uncalibrated_returns_zero);
+    RUN_TEST(test_pct_cal_without_calib);
+    RUN_TEST(test_bench_fixed_vs_float);
+    return UNITY_END();
+}
@@ -0,0 +1,228 @@
+// Sensor-Telemetrie ohne Hardware: Line-Protocol-Kodierung der Fenster und der Datensatz-Ring
+// zwischen Sampler und Publisher (Überlauf, Verluste, Fensterstatistik).
+// Ausführen: pio test -e native -f test_sensor_telemetry
+#include <string.h>
+#include <unity.h>
+
+#include "sensor_registry.h"
+#include "sensor_telemetry.h"
+
+static const sensor_channel_t s_channels[] = {
+    {.name = "temperature", .unit = "C", .decimals = 2},
+    {.name = "pressure", .unit = "hPa", .decimals = 1},
+};
+
+static const sensor_driver_t s_drv = {
+    .name = "bmx280",
+    .n_channels = 2,
+    .channels = s_channels,
+    .period_ms = 1000,
+};
+
+void setUp(void) {
+    sensor_window_t win;
+    sensor_window_collect(&win); // Ring zwischen den Tests leeren
+}
+
+void tearDown(void) {}
+
+static sensor_record_t record(const uint8_t sensor, const int64_t t_unix_us, const uint8_t valid,
+                              const float v0, const float v1) {
+    return (sensor_record_t){
+        .t_unix_us = t_unix_us,
+        .sensor = sensor,
+        .n_values = 2,
+        .valid = valid,
+        .values = {v0, v1},
+    };
+}
+
+static void test_line_lists_channels_in_order_with_ns_stamp(void) {
+    const sensor_stat_t stat[2] = {
+        {.min = 20.5f, .max = 21.5f, .sum = 63.0f, .n = 3},
+        {.min = 1000.0f, .max = 1002.0f, .sum = 2002.0f, .n = 2},
+    };
+    char buf[256];
+    const int n = sensor_telemetry_format_line(buf, sizeof(buf), &s_drv, stat, 1700000000123456);
+    const char* expected =
+        "sensor,sensor=bmx280 "
+        "temperature=21.00,temperature_min=20.50,temperature_max=21.50,temperature_n=3i,"
+        "pressure=1001.0,pressure_min=1000.0,pressure_max=1002.0,pressure_n=2i "
+        "1700000000123456000\n";
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+    TEST_ASSERT_EQUAL(strlen(expected), n);
+}
+
+static void test_line_without_stamp_skips_empty_channels(void) {
+    const sensor_stat_t stat[2] = {
+        {.n = 0},
+        {.min = 990.0f, .max = 990.0f, .sum = 990.0f, .n = 1},
+    };
+    char buf[256];
+    const int n = sensor_telemetry_format_line(buf, sizeof(buf), &s_drv, stat, 0);
+    const char* expected = "sensor,sensor=bmx280 pressure=990.0,pressure_min=990.0,pressure_max=990.0,pressure_n=1i\n";
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+    TEST_ASSERT_EQUAL(strlen(expected), n);
+}
+
+static void test_line_without_values_is_empty(void) {
+    const sensor_stat_t stat[2] = {0};
+    char buf[64];
+    TEST_ASSERT_EQUAL(0, sensor_telemetry_format_line(buf, sizeof(buf), &s_drv, stat, 1700000000000000));
+}
+
+static void test_line_reports_overflow_at_every_cut(void) {
+    const sensor_stat_t stat[2] = {
+        {.min = -5.25f, .max = 30.0f, .sum = 49.5f, .n = 4},
+        {.min = 980.0f, .max = 1030.0f, .sum = 4020.0f, .n = 4},
+    };
+    char full[256];
+    const int len = sensor_telemetry_format_line(full, sizeof(full), &s_drv, stat, 1700000000000001);
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    // Jede Größe ohne Platz für Zeile und Nullterminator meldet -1, statt abgeschnitten zu liefern
+    char buf[256];
+    for (size_t size = 0; size <= (size_t)len; ++size) {
+        TEST_ASSERT_EQUAL_MESSAGE(-1, sensor_telemetry_format_line(buf, size, &s_drv, stat, 1700000000000001),
+                                  "truncated line accepted");
+    }
+    TEST_ASSERT_EQUAL(len, sensor_telemetry_format_line(buf, (size_t)len + 1, &s_drv, stat, 1700000000000001));
+    TEST_ASSERT_EQUAL_STRING(full, buf);
+}
+
+static void test_longest_line_fits_line_max_len(void) {
+    // Alles an den Grenzen des Registers: Namen, Nachkommastellen, Kanäle, Zähler und Zeitstempel
+    static const sensor_channel_t channels[SENSOR_MAX_CHANNELS] = {
+        {.name = "abcdefghijklmn0", .decimals = SENSOR_MAX_DECIMALS},
+        {.name = "abcdefghijklmn1", .decimals = SENSOR_MAX_DECIMALS},
+        {.name = "abcdefghijklmn2", .decimals = SENSOR_MAX_DECIMALS},
+        {.name = "abcdefghijklmn3", .decimals = SENSOR_MAX_DECIMALS},
+    };
+    const sensor_driver_t drv = {
+        .name = "drivername12345",
+        .n_channels = SENSOR_MAX_CHANNELS,
+        .channels = channels,
+        .period_ms = 1000,
+    };
+    TEST_ASSERT_EQUAL(SENSOR_NAME_MAX_LEN, strlen(drv.name));
+    TEST_ASSERT_EQUAL(SENSOR_NAME_MAX_LEN, strlen(channels[0].name));
+
+    // -9999999 * 2^32 ist als float exakt, der Mittelwert daher genau -9999999
+    sensor_stat_t stat[SENSOR_MAX_CHANNELS];
+    for (size_t c = 0; c < SENSOR_MAX_CHANNELS; ++c) {
+        stat[c] = (sensor_stat_t){.min = -9999999.0f, .max = -9999999.0f, .sum = -9999999.0f * 4294967296.0f,
+                                  .n = UINT32_MAX};
+    }
+    char buf[SENSOR_TELEMETRY_LINE_MAX_LEN];
+    const int n = sensor_telemetry_format_line(buf, sizeof(buf), &drv, stat, INT64_MAX);
+    TEST_ASSERT_EQUAL(SENSOR_TELEMETRY_LINE_MAX_LEN - 1, n);
+}
+
+static esp_err_t read_nothing(sensor_record_t* rec) {
+    (void)rec;
+    return ESP_OK;
+}
+
+static void test_register_rejects_names_and_decimals_beyond_limits(void) {
+    const sensor_channel_t long_name[] = {{.name = "abcdefghijklmnop", .decimals = 1}};
+    const sensor_channel_t many_decimals[] = {{.name = "x", .decimals = SENSOR_MAX_DECIMALS + 1}};
+    const sensor_channel_t ok[] = {{.name = "x", .decimals = SENSOR_MAX_DECIMALS}};
+    sensor_driver_t drv = {.name = "d", .n_channels = 1, .channels = long_name, .period_ms = 1000,
+                           .read = read_nothing};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_register(&drv));
+    drv.channels = many_decimals;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_register(&drv));
+    drv.channels = ok;
+    drv.name = "abcdefghijklmnop";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_register(&drv));
+    drv.name = "";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_register(&drv));
+    drv.name = "d";
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_register(&drv));
+}
+
+static void test_window_aggregates_per_sensor_and_channel(void) {
+    const sensor_record_t recs[] = {
+        record(0, 1000, 0x3, 20.0f, 1000.0f),
+        record(0, 3000, 0x1, 22.0f, 0.0f),       // pressure ungültig
+        record(1, 2000, 0x2, 0.0f, 400.0f),
+        record(1, 9000, 0x0, 0.0f, 0.0f),        // Anlaufphase: zählt nur als Datensatz
+        record(0, 0, 0x3, 24.0f, 1004.0f),       // ohne NTP-Zeit
+        record(SENSOR_MAX_DRIVERS, 5000, 0x3, 1.0f, 1.0f), // ungültiger Index
+    };
+    for (size_t i = 0; i < sizeof(recs) / sizeof(recs[0]); ++i) sensor_ring_push(&recs[i]);
+
+    sensor_window_t win;
+    TEST_ASSERT_EQUAL(6, sensor_window_collect(&win));
+    TEST_ASSERT_EQUAL(6, win.n_records);
+
+    const sensor_stat_t* t = &win.stat[0][0];
+    TEST_ASSERT_EQUAL(3, t->n);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, t->min);
+    TEST_ASSERT_EQUAL_FLOAT(24.0f, t->max);
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, sensor_stat_mean(t));
+    const sensor_stat_t* p = &win.stat[0][1];
+    TEST_ASSERT_EQUAL(2, p->n);
+    TEST_ASSERT_EQUAL_FLOAT(1002.0f, sensor_stat_mean(p));
+    TEST_ASSERT_EQUAL(0, win.stat[1][0].n);
+    TEST_ASSERT_EQUAL(1, win.stat[1][1].n);
+    TEST_ASSERT_EQUAL_FLOAT(400.0f, win.stat[1][1].min);
+
+    // Jüngster Messbeginn mit gültigen Werten; Datensätze ohne Werte stempeln nicht
+    TEST_ASSERT_EQUAL_INT64(3000, win.t_unix_us[0]);
+    TEST_ASSERT_EQUAL_INT64(2000, win.t_unix_us[1]);
+    TEST_ASSERT_EQUAL_INT64(0, win.t_unix_us[2]);
+
+    TEST_ASSERT_EQUAL(0, sensor_window_collect(&win));
+    TEST_ASSERT_EQUAL(0, win.stat[0][0].n);
+}
+
+static void test_ring_counts_drops_when_full(void) {
+    const uint32_t drops_before = sensor_ring_drops();
+    for (int i = 0; i < SENSOR_RING_DEPTH + 3; ++i) {
+        const sensor_record_t rec = record(0, 1000 + i, 0x1, (float)i, 0.0f);
+        sensor_ring_push(&rec);
+    }
+    TEST_ASSERT_EQUAL(drops_before + 3, sensor_ring_drops());
+
+    // Die ältesten bleiben, die überzähligen neuesten fehlen
+    sensor_window_t win;
+    TEST_ASSERT_EQUAL(SENSOR_RING_DEPTH, sensor_window_collect(&win));
+    TEST_ASSERT_EQUAL(SENSOR_RING_DEPTH, win.stat[0][0].n);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, win.stat[0][0].min);
+    TEST_ASSERT_EQUAL_FLOAT((float)(SENSOR_RING_DEPTH - 1), win.stat[0][0].max);
+    TEST_ASSERT_EQUAL_INT64(1000 + SENSOR_RING_DEPTH - 1, win.t_unix_us[0]);
+}
+
+static void test_ring_wraps_without_losing_records(void) {
+    // Mehrere Umläufe mit teilweise gefülltem Ring: Indizes laufen über die Tiefe hinaus
+    const uint32_t drops_before = sensor_ring_drops();
+    const int batch = SENSOR_RING_DEPTH / 2 + 3;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < batch; ++i) {
+            const sensor_record_t rec = record(1, round * 100 + i, 0x3, (float)(round * 100 + i), 1.0f);
+            sensor_ring_push(&rec);
+        }
+        sensor_window_t win;
+        TEST_ASSERT_EQUAL(batch, sensor_window_collect(&win));
+        TEST_ASSERT_EQUAL(batch, win.stat[1][0].n);
+        TEST_ASSERT_EQUAL_FLOAT((float)(round * 100), win.stat[1][0].min);
+        TEST_ASSERT_EQUAL_FLOAT((float)(round * 100 + batch - 1), win.stat[1][0].max);
+        TEST_ASSERT_EQUAL_FLOAT((float)batch, win.stat[1][1].sum);
+    }
+    TEST_ASSERT_EQUAL(drops_before, sensor_ring_drops());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_line_lists_channels_in_order_with_ns_stamp);
+    RUN_TEST(test_line_without_stamp_skips_empty_channels);
+    RUN_TEST(test_line_without_values_is_empty);
+    RUN_TEST(test_line_reports_overflow_at_every_cut);
+    RUN_TEST(test_longest_line_fits_line_max_len);
+    RUN_TEST(test_register_rejects_names_and_decimals_beyond_limits);
+    RUN_TEST(test_window_aggregates_per_sensor_and_channel);
+    RUN_TEST(test_ring_counts_drops_when_full);
+    RUN_TEST(test_ring_wraps_without_losing_records);
+    return UNITY_END();
+}